@@ -0,0 +1,38 @@
+/**
+  ******************************************************************************
+  * @file    command.h
+  * @brief   Line based command input over USART2.
+  ******************************************************************************
+  */
+
+#ifndef __COMMAND_H
+#define __COMMAND_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "main.h"
+
+/* One command per line: "<NAME> <args>\r\n", replies are telemetry records */
+#define COMMAND_LINE_MAX        32U
+#define COMMAND_RX_SIZE         64U    /* receive queue, power of two */
+
+typedef struct
+{
+  const char *name;
+  void (*handler)(const char *args);   /* args points past the name, "" if none */
+} Command_Entry_t;
+
+void Command_Init(const Command_Entry_t *pTable, uint8_t count);
+uint8_t Command_RxComplete(UART_HandleTypeDef *huart);
+void Command_RxError(UART_HandleTypeDef *huart);
+uint8_t Command_Process(void);
+
+extern uint32_t commandOverruns;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __COMMAND_H */
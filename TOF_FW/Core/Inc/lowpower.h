@@ -0,0 +1,37 @@
+/**
+  ******************************************************************************
+  * @file    lowpower.h
+  * @brief   STOP mode entry/exit and awake time accounting.
+  ******************************************************************************
+  */
+
+#ifndef __LOWPOWER_H
+#define __LOWPOWER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "main.h"
+
+typedef struct
+{
+  uint32_t awakeMs;       /* time spent running, SysTick is stopped in STOP */
+  uint32_t wakeups;       /* STOP exits */
+  uint32_t startSeconds;  /* RTC count at LowPower_Init */
+  uint32_t lastReport;    /* RTC count of the last PWR record */
+} LowPower_Stats_t;
+
+void LowPower_Init(uint32_t reportPeriodS);
+uint32_t LowPower_Seconds(void);
+void LowPower_Sleep(volatile uint8_t *pPending);
+void LowPower_Report(void);
+void LowPower_AlarmIRQHandler(void);
+
+extern LowPower_Stats_t lowPowerStats;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __LOWPOWER_H */
@@ -0,0 +1,73 @@
+/**
+  ******************************************************************************
+  * @file    scheduler.h
+  * @brief   Cooperative run to completion scheduler with event flags,
+  *          earliest deadline dispatch and idle time accounting.
+  ******************************************************************************
+  */
+
+#ifndef __SCHEDULER_H
+#define __SCHEDULER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "main.h"
+
+#define SCHED_MAX_TASKS         8U
+#define SCHED_SLEEP_MIN_US      1000U  /* WFI only if the next release is further, SysTick wakes every ms */
+
+/* Task body, gets the event flags that released it (0 = periodic release) */
+typedef void (*Sched_TaskFn)(uint32_t events);
+
+/* Called with nothing ready, untilUs = time to the next periodic release */
+typedef void (*Sched_IdleFn)(uint32_t untilUs);
+
+typedef struct
+{
+  const char  *name;
+  Sched_TaskFn run;
+  uint32_t     periodUs;    /* 0 = released by events only */
+  uint32_t     events;      /* event flags that release the task */
+  uint32_t     deadlineUs;  /* release to completion */
+  uint32_t     budgetUs;    /* expected worst case runtime */
+} Sched_TaskConfig_t;
+
+typedef struct
+{
+  const Sched_TaskConfig_t *pConfig;
+  uint32_t nextUs;          /* next periodic release */
+  uint32_t releaseUs;       /* when the task was seen ready */
+  uint8_t  released;
+  uint32_t runs;
+  uint32_t maxUs;           /* worst case runtime */
+  uint32_t totalUs;
+  uint32_t overruns;        /* runtime above budgetUs */
+  uint32_t misses;          /* completed after the deadline */
+} Sched_Task_t;
+
+typedef struct
+{
+  uint32_t windowStartUs;   /* stats window, restarted by Sched_ResetStats */
+  uint32_t idleUs;
+  uint32_t sleeps;
+  uint32_t maxLatencyUs;    /* release to start, all tasks */
+} Sched_Stats_t;
+
+HAL_StatusTypeDef Sched_Init(const Sched_TaskConfig_t *pTable, uint8_t count, Sched_IdleFn idle);
+void Sched_Signal(uint32_t events);
+void Sched_RunOnce(void);
+void Sched_ResetStats(void);
+uint8_t Sched_TaskCount(void);
+int Sched_Format(char *buf, size_t len);
+int Sched_TaskFormat(char *buf, size_t len, uint8_t index);
+
+extern Sched_Task_t schedTasks[SCHED_MAX_TASKS];
+extern Sched_Stats_t schedStats;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SCHEDULER_H */
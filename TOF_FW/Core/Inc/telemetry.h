@@ -0,0 +1,32 @@
+/**
+  ******************************************************************************
+  * @file    telemetry.h
+  * @brief   Line based telemetry over USART2.
+  ******************************************************************************
+  */
+
+#ifndef __TELEMETRY_H
+#define __TELEMETRY_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "main.h"
+
+/* One record per line: "<TAG>,<field>,<field>...\r\n" */
+#define TELEMETRY_LINE_MAX      128U
+#define TELEMETRY_TX_SIZE       1024U  /* transmit queue, ~90ms at 115200 */
+#define TELEMETRY_TIMEOUT_MS    20U    /* flush gives up after this long without progress */
+
+void Telemetry_Send(const char *fmt, ...) __attribute__((format(printf, 1, 2)));
+void Telemetry_Flush(void);
+void Telemetry_TxComplete(UART_HandleTypeDef *huart);
+
+extern uint32_t telemetryDropped;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TELEMETRY_H */
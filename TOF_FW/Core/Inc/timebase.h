@@ -0,0 +1,52 @@
+/**
+  ******************************************************************************
+  * @file    timebase.h
+  * @brief   Microsecond timebase on TIM2 and per stage latency histograms.
+  ******************************************************************************
+  */
+
+#ifndef __TIMEBASE_H
+#define __TIMEBASE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "main.h"
+
+/* Bin k counts latencies in [2^(k-1), 2^k) us, the last bin everything above */
+#define LATENCY_BINS            16U
+
+/* Latency stages */
+#define LATENCY_IRQ_TO_READ     0U  /* GPIO1 edge until the readout starts */
+#define LATENCY_READOUT         1U  /* I2C readout and result decoding */
+#define LATENCY_IRQ_TO_DONE     2U  /* GPIO1 edge until the sample is available */
+#define LATENCY_STAGES          3U
+
+typedef struct
+{
+  uint32_t irqUs;         /* interrupt assertion, the sample capture time */
+  uint32_t readStartUs;
+  uint32_t readEndUs;
+} Timebase_Stamp_t;
+
+typedef struct
+{
+  uint16_t bin[LATENCY_BINS];  /* saturating */
+  uint32_t count;
+  uint32_t maxUs;
+} Latency_Hist_t;
+
+void Timebase_Start(void);
+uint32_t Timebase_Us(void);
+void Timebase_Overflow(void);
+void Latency_Record(const Timebase_Stamp_t *pStamp);
+void Latency_Report(void);
+
+extern Latency_Hist_t latencyHist[LATENCY_STAGES];
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TIMEBASE_H */
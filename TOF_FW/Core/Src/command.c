@@ -0,0 +1,154 @@
+/**
+  ******************************************************************************
+  * @file    command.c
+  * @brief   Line based command input over USART2.
+  *
+  *          The receive interrupt only queues bytes. Command_Process()
+  *          assembles at most one line per call and runs its handler, so
+  *          parsing is done from a task with a bounded runtime.
+  *          Unknown commands are answered with "CMD,?,<line>".
+  ******************************************************************************
+  */
+
+#include "command.h"
+#include "telemetry.h"
+#include <string.h>
+
+extern UART_HandleTypeDef huart2;
+
+uint32_t commandOverruns;
+
+static const Command_Entry_t *commandTable;
+static uint8_t commandCount;
+static uint8_t rxByte;
+static uint8_t rxQueue[COMMAND_RX_SIZE];
+static volatile uint16_t rxHead;    /* receive interrupt */
+static volatile uint16_t rxTail;    /* Command_Process */
+static char commandLine[COMMAND_LINE_MAX];
+static uint8_t lineLen;
+static uint8_t lineTooLong;
+
+/**
+  * @brief  Sets the command table and starts receiving.
+  * @param  pTable: commands, must stay valid
+  * @param  count: number of commands
+  * @retval None
+  */
+void Command_Init(const Command_Entry_t *pTable, uint8_t count)
+{
+  commandTable = pTable;
+  commandCount = count;
+  rxHead = 0U;
+  rxTail = 0U;
+  lineLen = 0U;
+  lineTooLong = 0U;
+  HAL_UART_Receive_IT(&huart2, &rxByte, 1U);
+}
+
+/**
+  * @brief  Receive complete callback, queues the byte and re-arms.
+  * @param  huart: UART that received
+  * @retval 1 at the end of a line, the caller signals the command task
+  */
+uint8_t Command_RxComplete(UART_HandleTypeDef *huart)
+{
+  uint8_t c = rxByte;
+  uint16_t head = rxHead;
+
+  if (huart != &huart2)
+  {
+    return 0U;
+  }
+  HAL_UART_Receive_IT(&huart2, &rxByte, 1U);
+  if (((head + 1U) & (COMMAND_RX_SIZE - 1U)) == rxTail)
+  {
+    commandOverruns++;
+    return 0U;
+  }
+  rxQueue[head] = c;
+  rxHead = (head + 1U) & (COMMAND_RX_SIZE - 1U);
+  return (uint8_t)((c == '\r') || (c == '\n'));
+}
+
+/**
+  * @brief  Error callback, the HAL stops receiving on overrun or framing
+  *         errors, start again.
+  * @param  huart: UART with the error
+  * @retval None
+  */
+void Command_RxError(UART_HandleTypeDef *huart)
+{
+  if (huart != &huart2)
+  {
+    return;
+  }
+  commandOverruns++;
+  HAL_UART_Receive_IT(&huart2, &rxByte, 1U);
+}
+
+/**
+  * @brief  Runs the handler of one complete line.
+  * @param  line: zero terminated, not empty
+  * @retval None
+  */
+static void Command_Dispatch(char *line)
+{
+  char *args = strchr(line, ' ');
+  uint8_t i;
+
+  if (args != NULL)
+  {
+    *args++ = '\0';
+  }
+  else
+  {
+    args = &line[strlen(line)];
+  }
+  for (i = 0U; i < commandCount; i++)
+  {
+    if (strcmp(line, commandTable[i].name) == 0)
+    {
+      commandTable[i].handler(args);
+      return;
+    }
+  }
+  Telemetry_Send("CMD,?,%s\r\n", line);
+}
+
+/**
+  * @brief  Takes queued bytes up to the next end of line and runs it.
+  *         A partial line is kept for the next call, overlong lines are
+  *         dropped.
+  * @retval 1 if a line was run and more bytes are queued
+  */
+uint8_t Command_Process(void)
+{
+  while (rxTail != rxHead)
+  {
+    char c = (char)rxQueue[rxTail];
+
+    rxTail = (rxTail + 1U) & (COMMAND_RX_SIZE - 1U);
+    if ((c == '\r') || (c == '\n'))
+    {
+      uint8_t run = (uint8_t)((lineLen != 0U) && !lineTooLong);
+
+      commandLine[lineLen] = '\0';
+      lineLen = 0U;
+      lineTooLong = 0U;
+      if (run)
+      {
+        Command_Dispatch(commandLine);
+        return (uint8_t)(rxTail != rxHead);
+      }
+    }
+    else if (lineLen < (COMMAND_LINE_MAX - 1U))
+    {
+      commandLine[lineLen++] = c;
+    }
+    else
+    {
+      lineTooLong = 1U;
+    }
+  }
+  return 0U;
+}
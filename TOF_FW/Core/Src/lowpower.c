@@ -0,0 +1,164 @@
+/**
+  ******************************************************************************
+  * @file    lowpower.c
+  * @brief   STOP mode entry/exit and awake time accounting.
+  *
+  *          The RTC runs from LSI as a 1 s wall clock and keeps counting in
+  *          STOP, SysTick does not, so HAL ticks measure awake time only.
+  *          Awake ms per hour is the average current proxy reported in the
+  *          "PWR" telemetry record.
+  ******************************************************************************
+  */
+
+#include "lowpower.h"
+#include "telemetry.h"
+
+LowPower_Stats_t lowPowerStats;
+
+static uint32_t reportPeriod;
+static uint32_t awakeSince;
+
+static void RTC_WaitWriteDone(void)
+{
+  while ((RTC->CRL & RTC_CRL_RTOFF) == 0U)
+  {
+  }
+}
+
+static void RTC_SetAlarm(uint32_t seconds)
+{
+  RTC_WaitWriteDone();
+  RTC->CRL |= RTC_CRL_CNF;
+  RTC->ALRH = seconds >> 16;
+  RTC->ALRL = seconds & 0xFFFFU;
+  RTC->CRL &= ~RTC_CRL_CNF;
+  RTC_WaitWriteDone();
+}
+
+/**
+  * @brief  Starts the LSI clocked RTC and arms the periodic report alarm
+  *         so a quiet node still wakes up to send its PWR record.
+  * @param  reportPeriodS: seconds between PWR records
+  * @retval None
+  */
+void LowPower_Init(uint32_t reportPeriodS)
+{
+  reportPeriod = reportPeriodS;
+
+  /* BDCR and the RTC sit in the backup domain, its write access needs the
+     PWR and BKP interface clocks */
+  __HAL_RCC_PWR_CLK_ENABLE();
+  __HAL_RCC_BKP_CLK_ENABLE();
+  PWR->CR |= PWR_CR_DBP;
+  RCC->CSR |= RCC_CSR_LSION;
+  while ((RCC->CSR & RCC_CSR_LSIRDY) == 0U)
+  {
+  }
+  RCC->BDCR |= RCC_BDCR_RTCSEL_1 | RCC_BDCR_RTCEN;
+
+  RTC->CRL &= ~RTC_CRL_RSF;
+  while ((RTC->CRL & RTC_CRL_RSF) == 0U)
+  {
+  }
+  RTC_WaitWriteDone();
+  RTC->CRL |= RTC_CRL_CNF;
+  RTC->PRLH = 0U;
+  RTC->PRLL = LSI_VALUE - 1U;
+  RTC->CRL &= ~RTC_CRL_CNF;
+  RTC_WaitWriteDone();
+
+  /* alarm wakes the core from STOP through EXTI line 17 */
+  RTC->CRL &= ~RTC_CRL_ALRF;
+  RTC->CRH |= RTC_CRH_ALRIE;
+  EXTI->IMR |= EXTI_IMR_MR17;
+  EXTI->RTSR |= EXTI_RTSR_TR17;
+  HAL_NVIC_SetPriority(RTC_Alarm_IRQn, 3, 0);
+  HAL_NVIC_EnableIRQ(RTC_Alarm_IRQn);
+
+  lowPowerStats.awakeMs = 0U;
+  lowPowerStats.wakeups = 0U;
+  lowPowerStats.startSeconds = LowPower_Seconds();
+  lowPowerStats.lastReport = lowPowerStats.startSeconds;
+  RTC_SetAlarm(lowPowerStats.lastReport + reportPeriod);
+  awakeSince = HAL_GetTick();
+}
+
+/**
+  * @brief  RTC counter, read twice to avoid a torn 32 bit value.
+  * @retval seconds since the RTC was started
+  */
+uint32_t LowPower_Seconds(void)
+{
+  uint16_t high, low;
+
+  do
+  {
+    high = RTC->CNTH;
+    low = RTC->CNTL;
+  } while (high != RTC->CNTH);
+  return ((uint32_t)high << 16) | low;
+}
+
+/**
+  * @brief  Enters STOP with the regulator in low power mode and restores
+  *         the PLL clock on exit. Any EXTI line wakes the core.
+  * @param  pPending: event flag set from ISRs, STOP is skipped while it is set
+  * @retval None
+  */
+void LowPower_Sleep(volatile uint8_t *pPending)
+{
+  Telemetry_Flush();
+
+  /* with PRIMASK set a pending interrupt still ends WFI, so an event that
+     lands between the flag check and the WFI is not lost */
+  __disable_irq();
+  if ((pPending != NULL) && (*pPending != 0U))
+  {
+    __enable_irq();
+    return;
+  }
+  lowPowerStats.awakeMs += HAL_GetTick() - awakeSince;
+  HAL_SuspendTick();
+  HAL_PWR_EnterSTOPMode(PWR_LOWPOWERREGULATOR_ON, PWR_STOPENTRY_WFI);
+  __enable_irq();
+
+  /* back on HSI, the oscillator config needs a running tick for its timeouts */
+  HAL_ResumeTick();
+  SystemClock_Config();
+  awakeSince = HAL_GetTick();
+  lowPowerStats.wakeups++;
+}
+
+/**
+  * @brief  Sends the PWR record once per report period:
+  *         PWR,<uptime s>,<awake ms>,<wakeups>,<awake ms per hour>
+  * @retval None
+  */
+void LowPower_Report(void)
+{
+  uint32_t now = LowPower_Seconds();
+  uint32_t elapsed = now - lowPowerStats.startSeconds;
+  uint32_t awake = lowPowerStats.awakeMs + (HAL_GetTick() - awakeSince);
+  uint32_t perHour;
+
+  if ((now - lowPowerStats.lastReport) < reportPeriod)
+  {
+    return;
+  }
+  lowPowerStats.lastReport = now;
+  RTC_SetAlarm(now + reportPeriod);
+
+  perHour = (elapsed != 0U) ? (uint32_t)(((uint64_t)awake * 3600U) / elapsed) : 0U;
+  Telemetry_Send("PWR,%lu,%lu,%lu,%lu\r\n", (unsigned long)elapsed, (unsigned long)awake,
+                 (unsigned long)lowPowerStats.wakeups, (unsigned long)perHour);
+}
+
+/**
+  * @brief  Called from RTC_Alarm_IRQHandler, only has to clear the flags.
+  * @retval None
+  */
+void LowPower_AlarmIRQHandler(void)
+{
+  RTC->CRL &= ~RTC_CRL_ALRF;
+  EXTI->PR = EXTI_PR_PR17;
+}
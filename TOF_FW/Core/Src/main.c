@@ -24,6 +24,24 @@
 #pragma import(__use_no_semihosting)
 #include "stdio.h"
 #include "vl53l1x.h"
+#include "vl53l1x_presence.h"
+#include "vl53l1x_preset.h"
+#include "vl53l1x_budget.h"
+#include "telemetry.h"
+#include "lowpower.h"
+#include "timebase.h"
+#include "vl53l1x_recovery.h"
+#include "vl53l1x_busrecover.h"
+#include "vl53l1x_xfer.h"
+#include "vl53l1x_trigger.h"
+#include "vl53l1x_collision.h"
+#include "vl53l1x_continuous.h"
+#include "vl53l1x_predict.h"
+#include "vl53l1x_sharedirq.h"
+#include "vl53l1x_filter.h"
+#include "scheduler.h"
+#include "command.h"
+#include <stdlib.h>
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -33,6 +51,26 @@
 
 /* Private define ------------------------------------------------------------*/
 /* USER CODE BEGIN PD */
+#define RUN_MODE_RANGING   0	//back to back ranging, the sensor task collects every frame
+#define RUN_MODE_PRESENCE  1	//low power autonomous, MCU in STOP between GPIO1 events
+#define RUN_MODE_TRIGGERED 2	//single shot started by TIM4 at a fixed period
+
+#define PWR_REPORT_PERIOD_S  3600
+#define LAT_REPORT_PERIOD_MS 10000
+#define TRIGGER_PERIOD_US    50000
+#define SENSOR_POLL_US       100000	//a frame whose GPIO1 edge was missed is still collected
+#define STOP_NEAR_MM         150
+#define STOP_CLEAR_MM        200
+#define BOOT_ATTEMPTS        8	//bring-up runs at boot before the sensor task takes over the recovery
+#define RANGING_PRESET       LONG_RANGE	//preset table mode applied after every (re)init
+//#define VL53_XFER_BENCH	//time polled against DMA reads at boot, sets the crossover
+//#define VL53_COLLISION_FAST	//drive VL53_STOP from the GPIO1 interrupt, needs the I2C1 peripheral
+
+//scheduler event flags
+#define EVENT_VL53     (1U << 0)	//GPIO1 edge
+#define EVENT_SAMPLE   (1U << 1)	//new frame in sample, for the filter
+#define EVENT_COMMAND  (1U << 2)	//end of a command line received
+#define EVENT_REPORT   (1U << 3)	//next report record pending
 
 /* USER CODE END PD */
 
@@ -43,6 +81,11 @@
 
 /* Private variables ---------------------------------------------------------*/
 I2C_HandleTypeDef hi2c1;
+DMA_HandleTypeDef hdma_i2c1_rx;
+DMA_HandleTypeDef hdma_i2c1_tx;
+
+TIM_HandleTypeDef htim2;
+TIM_HandleTypeDef htim4;
 
 UART_HandleTypeDef huart2;
 
@@ -50,13 +93,87 @@ UART_HandleTypeDef huart2;
 uint8_t tmpconsole[512];
 uint16_t consoleindex = 0;
 
+uint8_t runMode = RUN_MODE_RANGING;
+volatile uint8_t vl53Event = 0;	//set by the GPIO1 EXTI
+Timebase_Stamp_t vl53Stamp;	//irqUs is taken in the EXTI callback
+
+recovery_state recovery;
+uint8_t vl53Down = 0;	//bring-up failed, the sensor task runs it again
+static VL53L1_Error vl53Reinit(VL53L1_Dev_t* pDev);
+static const recovery_config recoveryConfig =
+{
+	.maxRetries = 3,
+	.maxSoftResets = 2,
+	.busClear = 1,
+	.xshutPort = VL53_XSHUT_GPIO_Port,
+	.xshutPin = VL53_XSHUT_Pin,
+	.reinit = vl53Reinit,
+};
+
+trigger_state trigger;
+VL53L1_RangingMeasurementData_t triggerData;
+
+collision_state collision;
+continuous_state continuous;
+budget_cache budgetCache;	//encoded timeouts of the ranging preset, rebuilt on every (re)init
+uint32_t rangingBudgetUs = 0;	//set by BUDGET, 0 = the preset budget
+predict_state predict;	//skips the ranging data ready reads until the frame can be close
+sharedirq_state sharedIrq;	//finds the sensor behind a GPIO1 edge, more can join the line
+VL53L1_Error vl53Collected;	//result of the readout the shared interrupt ran
+static VL53L1_Error vl53Collect(uint8_t idx, VL53L1_Dev_t* pDev);
+
+filter_config filterConfig;
+filter_state filter;
+VL53L1_RangingMeasurementData_t sample;	//latest frame, handed from the sensor to the filter task
+uint8_t reportStep = 0;
+
+//every task runs to completion, budgets are the expected worst case at 100kHz I2C
+static void sensorTask(uint32_t events);
+static void filterTask(uint32_t events);
+static void commandTask(uint32_t events);
+static void telemetryTask(uint32_t events);
+static void presenceIdle(uint32_t untilUs);
+static const Sched_TaskConfig_t taskTable[] =
+{
+	//name         body           period us                     events         deadline us  budget us
+	{"sensor",     sensorTask,    SENSOR_POLL_US,               EVENT_VL53,    10000,       8000},
+	{"filter",     filterTask,    0,                            EVENT_SAMPLE,  5000,        500},
+	{"command",    commandTask,   0,                            EVENT_COMMAND, 50000,       2000},
+	{"telemetry",  telemetryTask, LAT_REPORT_PERIOD_MS * 1000,  EVENT_REPORT,  100000,      2000},
+};
+
+static void commandStat(const char *args);
+static void commandClear(const char *args);
+static void commandFilter(const char *args);
+static void commandBudget(const char *args);
+static const Command_Entry_t commandTable[] =
+{
+	{"STAT",   commandStat},	//send the full report now
+	{"CLR",    commandClear},	//restart the scheduler statistics
+	{"FILTER", commandFilter},	//FILTER <mode>, FILTER_xxx
+	{"BUDGET", commandBudget},	//BUDGET <us>, ranging timing budget
+};
+
+presence_state presence;
+static const presence_config presenceConfig =
+{
+	.lowMm = 50,
+	.highMm = 1200,
+	.timingBudgetUs = 20000,
+	.interMeasurementMs = 500,
+	.distanceMode = VL53L1_DISTANCEMODE_MEDIUM,
+};
+
 /* USER CODE END PV */
 
 /* Private function prototypes -----------------------------------------------*/
 void SystemClock_Config(void);
 static void MX_GPIO_Init(void);
+static void MX_DMA_Init(void);
 static void MX_USART2_UART_Init(void);
 static void MX_I2C1_Init(void);
+static void MX_TIM2_Init(void);
+static void MX_TIM4_Init(void);
 /* USER CODE BEGIN PFP */
 
 /* USER CODE END PFP */
@@ -95,11 +212,54 @@ int main(void)
 
   /* Initialize all configured peripherals */
   MX_GPIO_Init();
+  MX_DMA_Init();
   MX_USART2_UART_Init();
   MX_I2C1_Init();
+  MX_TIM2_Init();
+  MX_TIM4_Init();
   /* USER CODE BEGIN 2 */
-VL53L1Init(&VL53);
-VL53InitParam(&VL53, 2);
+Timebase_Start();
+VL53RecoveryInit(&recovery, &recoveryConfig);
+VL53SharedIrqInit(&sharedIrq, VL53_INT_GPIO_Port, VL53_INT_Pin, vl53Collect);
+//a reset in the middle of a read leaves the sensor holding SDA low
+VL53.I2cHandle = &hi2c1;
+if (VL53BusStuck())
+	VL53BusRecover(&VL53);
+if (runMode == RUN_MODE_PRESENCE)
+	LowPower_Init(PWR_REPORT_PERIOD_S);
+//a retry or a bus clear leaves the device where the failed step did, so the whole
+//bring-up runs again. a device that cannot be recovered is reported and the sensor
+//task keeps trying at its poll period
+{
+	uint8_t attempt = 0, result;
+
+	do
+		result = VL53RecoveryHandle(&VL53, &recovery, vl53Reinit(&VL53));
+	while (result != RECOVERY_OK && result != RECOVERY_FAILED && ++attempt < BOOT_ATTEMPTS);
+	vl53Down = result != RECOVERY_OK;
+	if (vl53Down)
+		Telemetry_Send("BOOT,%u,%d\r\n", result, recovery.stats.lastError);
+}
+#ifdef VL53_COLLISION_FAST
+if (runMode != RUN_MODE_PRESENCE)
+	VL53CollisionInit(&VL53, &collision, VL53_STOP_GPIO_Port, VL53_STOP_Pin, STOP_NEAR_MM, STOP_CLEAR_MM);
+#endif
+#ifdef VL53_XFER_BENCH
+{
+	xfer_bench bench;
+
+	if (VL53XferBench(&VL53, VL53L1_RESULT__RANGE_STATUS, &bench) == VL53L1_ERROR_NONE)
+	{
+		VL53XferBenchFormat((char *)tmpconsole, sizeof(tmpconsole), &bench);
+		Telemetry_Send("%s", (char *)tmpconsole);
+	}
+}
+#endif
+filterConfig = filterDefaultConfig;
+VL53FilterInit(&filter, &filterConfig);
+Command_Init(commandTable, sizeof(commandTable) / sizeof(commandTable[0]));
+Sched_Init(taskTable, sizeof(taskTable) / sizeof(taskTable[0]),
+		runMode == RUN_MODE_PRESENCE ? presenceIdle : NULL);
   /* USER CODE END 2 */
 
   /* Infinite loop */
@@ -109,7 +269,7 @@ VL53InitParam(&VL53, 2);
     /* USER CODE END WHILE */
 
     /* USER CODE BEGIN 3 */
-	  getDistance(&VL53);
+	  Sched_RunOnce();
   }
   /* USER CODE END 3 */
 }
@@ -187,6 +347,96 @@ static void MX_I2C1_Init(void)
 
 }
 
+/**
+  * @brief TIM2 Initialization Function
+  * @param None
+  * @retval None
+  */
+static void MX_TIM2_Init(void)
+{
+
+  /* USER CODE BEGIN TIM2_Init 0 */
+
+  /* USER CODE END TIM2_Init 0 */
+
+  TIM_ClockConfigTypeDef sClockSourceConfig = {0};
+  TIM_MasterConfigTypeDef sMasterConfig = {0};
+
+  /* USER CODE BEGIN TIM2_Init 1 */
+
+  /* USER CODE END TIM2_Init 1 */
+  htim2.Instance = TIM2;
+  htim2.Init.Prescaler = 71;
+  htim2.Init.CounterMode = TIM_COUNTERMODE_UP;
+  htim2.Init.Period = 65535;
+  htim2.Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
+  htim2.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_DISABLE;
+  if (HAL_TIM_Base_Init(&htim2) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  sClockSourceConfig.ClockSource = TIM_CLOCKSOURCE_INTERNAL;
+  if (HAL_TIM_ConfigClockSource(&htim2, &sClockSourceConfig) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  sMasterConfig.MasterOutputTrigger = TIM_TRGO_RESET;
+  sMasterConfig.MasterSlaveMode = TIM_MASTERSLAVEMODE_DISABLE;
+  if (HAL_TIMEx_MasterConfigSynchronization(&htim2, &sMasterConfig) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  /* USER CODE BEGIN TIM2_Init 2 */
+
+  /* USER CODE END TIM2_Init 2 */
+
+}
+
+/**
+  * @brief TIM4 Initialization Function
+  * @param None
+  * @retval None
+  */
+static void MX_TIM4_Init(void)
+{
+
+  /* USER CODE BEGIN TIM4_Init 0 */
+
+  /* USER CODE END TIM4_Init 0 */
+
+  TIM_ClockConfigTypeDef sClockSourceConfig = {0};
+  TIM_MasterConfigTypeDef sMasterConfig = {0};
+
+  /* USER CODE BEGIN TIM4_Init 1 */
+  //1 MHz, the period is set by VL53TriggerStart()
+  /* USER CODE END TIM4_Init 1 */
+  htim4.Instance = TIM4;
+  htim4.Init.Prescaler = 71;
+  htim4.Init.CounterMode = TIM_COUNTERMODE_UP;
+  htim4.Init.Period = 49999;
+  htim4.Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
+  htim4.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_DISABLE;
+  if (HAL_TIM_Base_Init(&htim4) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  sClockSourceConfig.ClockSource = TIM_CLOCKSOURCE_INTERNAL;
+  if (HAL_TIM_ConfigClockSource(&htim4, &sClockSourceConfig) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  sMasterConfig.MasterOutputTrigger = TIM_TRGO_RESET;
+  sMasterConfig.MasterSlaveMode = TIM_MASTERSLAVEMODE_DISABLE;
+  if (HAL_TIMEx_MasterConfigSynchronization(&htim4, &sMasterConfig) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  /* USER CODE BEGIN TIM4_Init 2 */
+
+  /* USER CODE END TIM4_Init 2 */
+
+}
+
 /**
   * @brief USART2 Initialization Function
   * @param None
@@ -220,6 +470,25 @@ static void MX_USART2_UART_Init(void)
 
 }
 
+/**
+  * Enable DMA controller clock
+  */
+static void MX_DMA_Init(void)
+{
+
+  /* DMA controller clock enable */
+  __HAL_RCC_DMA1_CLK_ENABLE();
+
+  /* DMA interrupt init */
+  /* DMA1_Channel6_IRQn interrupt configuration */
+  HAL_NVIC_SetPriority(DMA1_Channel6_IRQn, 0, 0);
+  HAL_NVIC_EnableIRQ(DMA1_Channel6_IRQn);
+  /* DMA1_Channel7_IRQn interrupt configuration */
+  HAL_NVIC_SetPriority(DMA1_Channel7_IRQn, 0, 0);
+  HAL_NVIC_EnableIRQ(DMA1_Channel7_IRQn);
+
+}
+
 /**
   * @brief GPIO Initialization Function
   * @param None
@@ -237,6 +506,12 @@ static void MX_GPIO_Init(void)
   __HAL_RCC_GPIOA_CLK_ENABLE();
   __HAL_RCC_GPIOB_CLK_ENABLE();
 
+  /*Configure GPIO pin Output Level */
+  HAL_GPIO_WritePin(VL53_XSHUT_GPIO_Port, VL53_XSHUT_Pin, GPIO_PIN_SET);
+
+  /*Configure GPIO pin Output Level */
+  HAL_GPIO_WritePin(VL53_STOP_GPIO_Port, VL53_STOP_Pin, GPIO_PIN_RESET);
+
   /*Configure GPIO pin Output Level */
   HAL_GPIO_WritePin(LD2_GPIO_Port, LD2_Pin, GPIO_PIN_RESET);
 
@@ -246,6 +521,26 @@ static void MX_GPIO_Init(void)
   GPIO_InitStruct.Pull = GPIO_NOPULL;
   HAL_GPIO_Init(B1_GPIO_Port, &GPIO_InitStruct);
 
+  /*Configure GPIO pin : VL53_XSHUT_Pin */
+  GPIO_InitStruct.Pin = VL53_XSHUT_Pin;
+  GPIO_InitStruct.Mode = GPIO_MODE_OUTPUT_PP;
+  GPIO_InitStruct.Pull = GPIO_NOPULL;
+  GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_LOW;
+  HAL_GPIO_Init(VL53_XSHUT_GPIO_Port, &GPIO_InitStruct);
+
+  /*Configure GPIO pin : VL53_STOP_Pin */
+  GPIO_InitStruct.Pin = VL53_STOP_Pin;
+  GPIO_InitStruct.Mode = GPIO_MODE_OUTPUT_PP;
+  GPIO_InitStruct.Pull = GPIO_NOPULL;
+  GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_HIGH;
+  HAL_GPIO_Init(VL53_STOP_GPIO_Port, &GPIO_InitStruct);
+
+  /*Configure GPIO pin : VL53_INT_Pin */
+  GPIO_InitStruct.Pin = VL53_INT_Pin;
+  GPIO_InitStruct.Mode = GPIO_MODE_IT_FALLING;
+  GPIO_InitStruct.Pull = GPIO_PULLUP;
+  HAL_GPIO_Init(VL53_INT_GPIO_Port, &GPIO_InitStruct);
+
   /*Configure GPIO pin : LD2_Pin */
   GPIO_InitStruct.Pin = LD2_Pin;
   GPIO_InitStruct.Mode = GPIO_MODE_OUTPUT_PP;
@@ -254,15 +549,334 @@ static void MX_GPIO_Init(void)
   HAL_GPIO_Init(LD2_GPIO_Port, &GPIO_InitStruct);
 
   /* EXTI interrupt init*/
+  HAL_NVIC_SetPriority(EXTI4_IRQn, 1, 0);
+  HAL_NVIC_EnableIRQ(EXTI4_IRQn);
+
   HAL_NVIC_SetPriority(EXTI15_10_IRQn, 0, 0);
   HAL_NVIC_EnableIRQ(EXTI15_10_IRQn);
 
 /* USER CODE BEGIN MX_GPIO_Init_2 */
   HAL_GPIO_WritePin(GPIOB, VL53_SDA_Pin|VL53_SCL_Pin, GPIO_PIN_RESET);
+  /* VL53_INT: GPIO1 is open drain active low. VL53_XSHUT: high = sensor enabled.
+     VL53_STOP: high = object inside the stop distance */
 /* USER CODE END MX_GPIO_Init_2 */
 }
 
 /* USER CODE BEGIN 4 */
+//full bring up, used at boot and by the recovery after a reset or power cycle
+static VL53L1_Error vl53Reinit(VL53L1_Dev_t* pDev)
+{
+	VL53L1_Error Status;
+
+	//no trigger may hit the device while it is brought up
+	if (trigger.running)
+		VL53TriggerStop(&trigger);
+	Status = VL53L1Init(pDev);
+	if (Status == VL53L1_ERROR_NONE)
+		Status = VL53PresetApply(pDev, RANGING_PRESET);
+	if (Status == VL53L1_ERROR_NONE)
+		Status = VL53BudgetCacheBuild(pDev, &budgetCache, RANGING_PRESET, budgetDefaultList, BUDGET_CACHE_MAX);
+	if (Status == VL53L1_ERROR_NONE && rangingBudgetUs != 0 && runMode == RUN_MODE_RANGING)
+		Status = VL53BudgetSet(pDev, &budgetCache, RANGING_PRESET, rangingBudgetUs);
+	if (Status == VL53L1_ERROR_NONE && runMode == RUN_MODE_PRESENCE)
+		Status = VL53PresenceStart(pDev, &presence, &presenceConfig);
+	if (Status == VL53L1_ERROR_NONE && runMode == RUN_MODE_TRIGGERED)
+		Status = VL53TriggerStart(pDev, &trigger, &htim4, TRIGGER_PERIOD_US);
+	//the sensor task only collects frames, it never waits for one. the device takes its
+	//own slot on the shared GPIO1 line again with the period the predictor read back,
+	//the other sources on the line keep theirs
+	if (Status == VL53L1_ERROR_NONE && runMode == RUN_MODE_RANGING)
+		Status = VL53PredictInit(pDev, &predict, 0, 0);
+	if (Status == VL53L1_ERROR_NONE && runMode == RUN_MODE_RANGING)
+		if (VL53SharedIrqAdd(&sharedIrq, pDev, predict.nominalUs) < 0)
+			Status = VL53L1_ERROR_CONTROL_INTERFACE;
+	if (Status == VL53L1_ERROR_NONE && runMode == RUN_MODE_RANGING)
+		Status = VL53ContinuousStart(pDev, &continuous);
+	if (Status == VL53L1_ERROR_NONE && runMode == RUN_MODE_RANGING)
+		VL53PredictStart(&predict);
+	return Status;
+}
+
+//collects the frame of the current run mode, released by GPIO1 or the poll period
+static void sensorTask(uint32_t events)
+{
+	if (vl53Down)
+	{
+		vl53Down = VL53RecoveryHandle(&VL53, &recovery, vl53Reinit(&VL53)) != RECOVERY_OK;
+		return;
+	}
+#ifdef VL53_COLLISION_FAST
+	VL53CollisionService(&collision);
+#endif
+	if (runMode == RUN_MODE_PRESENCE)
+	{
+		if (!vl53Event)
+			return;
+		vl53Event = 0;
+		vl53Stamp.readStartUs = Timebase_Us();
+		if (VL53RecoveryHandle(&VL53, &recovery, VL53PresenceService(&VL53, &presence)) == RECOVERY_OK)
+		{
+			vl53Stamp.readEndUs = Timebase_Us();
+			presence.last.TimeStamp = vl53Stamp.irqUs;	//us, capture time
+			Latency_Record(&vl53Stamp);
+			Telemetry_Send("PRS,%u,%d,%u,%lu\r\n", presence.present,
+					presence.last.RangeMilliMeter, presence.last.RangeStatus,
+					(unsigned long)presence.last.TimeStamp);
+		}
+	}
+	else if (runMode == RUN_MODE_TRIGGERED)
+	{
+		VL53L1_Error Status;
+		uint8_t fresh, action;
+
+		vl53Stamp.readStartUs = Timebase_Us();
+		Status = VL53TriggerService(&trigger, &triggerData, &fresh);
+		//no trigger write from TIM4 while the recovery clears the bus or resets the device
+		trigger.readout = 1;
+		action = VL53RecoveryHandle(&VL53, &recovery, Status);
+		trigger.readout = 0;
+		if (action == RECOVERY_OK && fresh)
+		{
+			vl53Stamp.readEndUs = Timebase_Us();
+			Latency_Record(&vl53Stamp);
+			Telemetry_Send("SMP,%d,%u,%lu\r\n", triggerData.RangeMilliMeter, triggerData.RangeStatus,
+					(unsigned long)triggerData.TimeStamp);
+			sample = triggerData;
+			Sched_Signal(EVENT_SAMPLE);
+		}
+	}
+	else
+	{
+		VL53L1_Error Status;
+		uint8_t ready = 0;
+
+		//released by the poll period: no read before the predicted end of the frame,
+		//then the readout start stands in for the edge
+		if (!(events & EVENT_VL53) && !VL53PredictDue(&predict))
+			return;
+		vl53Stamp.readStartUs = Timebase_Us();
+		if (events & EVENT_VL53)
+		{
+			//the interrupt status read finds the sensor behind the edge, vl53Collect() reads it out
+			vl53Collected = VL53L1_ERROR_NONE;
+			ready = VL53SharedIrqService(&sharedIrq, vl53Stamp.irqUs) != 0;
+			Status = vl53Collected;
+		}
+		else
+		{
+			vl53Stamp.irqUs = vl53Stamp.readStartUs;
+			Status = VL53PredictPoll(&VL53, &predict, &ready);
+			if (Status == VL53L1_ERROR_NONE && ready)
+				Status = VL53ContinuousService(&VL53, &continuous, vl53Stamp.irqUs);
+		}
+		//the synchronisation frame after start is not handed on
+		if (VL53RecoveryHandle(&VL53, &recovery, Status) == RECOVERY_OK && ready &&
+				VL53ContinuousGet(&continuous, &sample))
+		{
+			vl53Stamp.readEndUs = Timebase_Us();
+			Latency_Record(&vl53Stamp);
+			sample.TimeStamp = vl53Stamp.irqUs;
+			distance = sample.RangeMilliMeter;
+			Sched_Signal(EVENT_SAMPLE);
+		}
+	}
+}
+
+//shared interrupt service callback, the frame end is the edge
+static VL53L1_Error vl53Collect(uint8_t idx, VL53L1_Dev_t* pDev)
+{
+	VL53PredictReady(&predict, vl53Stamp.irqUs);
+	vl53Collected = VL53ContinuousService(pDev, &continuous, vl53Stamp.irqUs);
+	return vl53Collected;
+}
+
+static void filterTask(uint32_t events)
+{
+	int32_t filtered;
+	uint8_t result = VL53FilterUpdate(&filter, &sample, &filtered);
+
+	if (result != FILTER_NO_DATA)
+		Telemetry_Send("FLT,%ld,%d,%u,%u,%lu\r\n", (long)filtered, sample.RangeMilliMeter,
+				sample.RangeStatus, result, (unsigned long)sample.TimeStamp);
+}
+
+//one line per run, the rest comes back as another release
+static void commandTask(uint32_t events)
+{
+	if (Command_Process())
+		Sched_Signal(EVENT_COMMAND);
+}
+
+//one report record per run so ranging is never held up by a whole report,
+//every step but the last releases the next one
+static void telemetryTask(uint32_t events)
+{
+	uint8_t step = reportStep++;
+	uint8_t tasks = Sched_TaskCount();
+
+	if (step == 0)
+		Latency_Report();
+	else if (step == 1)
+	{
+		VL53RecoveryFormat((char *)tmpconsole, sizeof(tmpconsole), &recovery.stats);
+		Telemetry_Send("%s", (char *)tmpconsole);
+	}
+	else if (step == 2 && runMode == RUN_MODE_TRIGGERED)
+	{
+		VL53TriggerFormat((char *)tmpconsole, sizeof(tmpconsole), &trigger);
+		Telemetry_Send("%s", (char *)tmpconsole);
+	}
+	else if (step == 2 && runMode == RUN_MODE_RANGING)
+	{
+		VL53ContinuousFormat((char *)tmpconsole, sizeof(tmpconsole), &continuous);
+		Telemetry_Send("%s", (char *)tmpconsole);
+		VL53PredictFormat((char *)tmpconsole, sizeof(tmpconsole), &predict);
+		Telemetry_Send("%s", (char *)tmpconsole);
+		VL53SharedIrqFormat((char *)tmpconsole, sizeof(tmpconsole), &sharedIrq);
+		Telemetry_Send("%s", (char *)tmpconsole);
+	}
+#ifdef VL53_COLLISION_FAST
+	else if (step == 3)
+	{
+		VL53CollisionFormat((char *)tmpconsole, sizeof(tmpconsole), &collision);
+		Telemetry_Send("%s", (char *)tmpconsole);
+	}
+#endif
+	else if (step == 4)
+	{
+		Sched_Format((char *)tmpconsole, sizeof(tmpconsole));
+		Telemetry_Send("%s", (char *)tmpconsole);
+		Telemetry_Send("TEL,%lu,%lu\r\n", (unsigned long)telemetryDropped, (unsigned long)commandOverruns);
+	}
+	else if (step >= 5 && step < 5 + tasks)
+	{
+		Sched_TaskFormat((char *)tmpconsole, sizeof(tmpconsole), step - 5);
+		Telemetry_Send("%s", (char *)tmpconsole);
+	}
+	if (reportStep < 5 + tasks)
+		Sched_Signal(EVENT_REPORT);
+	else
+		reportStep = 0;
+}
+
+//presence mode sleeps in STOP, the scheduler time stands still meanwhile
+static void presenceIdle(uint32_t untilUs)
+{
+	LowPower_Report();
+	LowPower_Sleep(&vl53Event);
+}
+
+static void commandStat(const char *args)
+{
+	reportStep = 0;
+	Sched_Signal(EVENT_REPORT);
+}
+
+static void commandClear(const char *args)
+{
+	Sched_ResetStats();
+	Telemetry_Send("CMD,OK,CLR\r\n");
+}
+
+static void commandFilter(const char *args)
+{
+	unsigned long mode = strtoul(args, NULL, 10);
+
+	if (*args == '\0' || mode > FILTER_MEDIAN_KALMAN)
+	{
+		Telemetry_Send("CMD,ERR,FILTER\r\n");
+		return;
+	}
+	filterConfig.mode = (uint8_t)mode;
+	VL53FilterReset(&filter);
+	Telemetry_Send("CMD,OK,FILTER,%lu\r\n", mode);
+}
+
+//ranging restarts with the new budget, a cached one costs no timeout calculation.
+//the budget also holds for every later (re)init
+static void commandBudget(const char *args)
+{
+	unsigned long us = strtoul(args, NULL, 10);
+	VL53L1_Error Status;
+
+	if (*args == '\0' || us == 0 || runMode != RUN_MODE_RANGING || vl53Down)
+	{
+		Telemetry_Send("CMD,ERR,BUDGET\r\n");
+		return;
+	}
+	Status = VL53ContinuousStop(&VL53);
+	if (Status == VL53L1_ERROR_NONE)
+		Status = VL53BudgetSet(&VL53, &budgetCache, RANGING_PRESET, us);
+	if (Status == VL53L1_ERROR_NONE)
+		Status = VL53PredictInit(&VL53, &predict, 0, 0);
+	if (Status == VL53L1_ERROR_NONE)
+		Status = VL53ContinuousStart(&VL53, &continuous);
+	if (Status == VL53L1_ERROR_NONE)
+		VL53PredictStart(&predict);
+	if (Status == VL53L1_ERROR_NONE)
+		rangingBudgetUs = us;
+	if (VL53RecoveryHandle(&VL53, &recovery, Status) != RECOVERY_OK)
+	{
+		Telemetry_Send("CMD,ERR,BUDGET,%d\r\n", Status);
+		return;
+	}
+	Telemetry_Send("CMD,OK,BUDGET,%lu,%lu,%lu\r\n", us, (unsigned long)budgetCache.hits,
+			(unsigned long)budgetCache.misses);
+}
+
+void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin)
+{
+	if (GPIO_Pin == VL53_INT_Pin)
+	{
+		vl53Stamp.irqUs = Timebase_Us();
+		vl53Event = 1;
+		Sched_Signal(EVENT_VL53);
+		//pending first, a trigger tick must not take the bus under the readout
+		VL53TriggerDataReady(&trigger);
+#ifdef VL53_COLLISION_FAST
+		VL53CollisionIsr(&collision);
+#endif
+	}
+}
+
+void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim)
+{
+	if (htim->Instance == TIM2)
+		Timebase_Overflow();
+	else if (htim->Instance == TIM4)
+		VL53TriggerTick(&trigger);
+}
+
+void HAL_I2C_MemRxCpltCallback(I2C_HandleTypeDef *hi2c)
+{
+	VL53XferComplete(hi2c, 0);
+}
+
+void HAL_I2C_MemTxCpltCallback(I2C_HandleTypeDef *hi2c)
+{
+	VL53XferComplete(hi2c, 0);
+}
+
+void HAL_I2C_ErrorCallback(I2C_HandleTypeDef *hi2c)
+{
+	VL53XferComplete(hi2c, 1);
+}
+
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
+{
+	Telemetry_TxComplete(huart);
+}
+
+void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart)
+{
+	if (Command_RxComplete(huart))
+		Sched_Signal(EVENT_COMMAND);
+}
+
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart)
+{
+	Command_RxError(huart);
+}
 
 /* USER CODE END 4 */
 
@@ -274,10 +888,10 @@ void Error_Handler(void)
 {
   /* USER CODE BEGIN Error_Handler_Debug */
   /* User can add his own implementation to report the HAL error return state */
+  /* HAL init failures are not recoverable in place, a reset brings the node back
+     instead of leaving it offline; sensor errors go through VL53RecoveryHandle() */
   __disable_irq();
-  while (1)
-  {
-  }
+  NVIC_SystemReset();
   /* USER CODE END Error_Handler_Debug */
 }
 
@@ -0,0 +1,266 @@
+/**
+  ******************************************************************************
+  * @file    scheduler.c
+  * @brief   Cooperative run to completion scheduler with event flags,
+  *          earliest deadline dispatch and idle time accounting.
+  *
+  *          Tasks come from a fixed table and always run to completion, so
+  *          the ranging latency only depends on the longest task body. A
+  *          task is released by its period or by event flags that ISRs set
+  *          with Sched_Signal(). Of the released tasks the one with the
+  *          earliest absolute deadline runs first. Runtime, worst case
+  *          runtime, budget overruns and deadline misses are kept per task,
+  *          time with nothing ready is accounted as idle. Times come from
+  *          Timebase_Us(), which stops in STOP mode.
+  ******************************************************************************
+  */
+
+#include "scheduler.h"
+#include "timebase.h"
+#include <stdio.h>
+#include <string.h>
+
+Sched_Task_t schedTasks[SCHED_MAX_TASKS];
+Sched_Stats_t schedStats;
+
+static uint8_t schedCount;
+static Sched_IdleFn schedIdle;
+static volatile uint32_t schedEvents;
+
+/**
+  * @brief  Default idle: sleeps until the next interrupt unless a periodic
+  *         release is close. An event set after the ready scan still ends
+  *         the WFI, PRIMASK only delays its handler.
+  * @param  untilUs: time to the next periodic release
+  * @retval None
+  */
+static void Sched_DefaultIdle(uint32_t untilUs)
+{
+  if (untilUs < SCHED_SLEEP_MIN_US)
+  {
+    return;
+  }
+  __disable_irq();
+  if (schedEvents == 0U)
+  {
+    __WFI();
+    schedStats.sleeps++;
+  }
+  __enable_irq();
+}
+
+/**
+  * @brief  Loads the task table, periodic tasks are first released one
+  *         period from now.
+  * @param  pTable: task configurations, must stay valid
+  * @param  count: number of tasks, up to SCHED_MAX_TASKS
+  * @param  idle: idle hook, NULL for the default WFI sleep
+  * @retval HAL_ERROR if the table does not fit
+  */
+HAL_StatusTypeDef Sched_Init(const Sched_TaskConfig_t *pTable, uint8_t count, Sched_IdleFn idle)
+{
+  uint32_t now = Timebase_Us();
+  uint8_t i;
+
+  if (count > SCHED_MAX_TASKS)
+  {
+    return HAL_ERROR;
+  }
+  memset(schedTasks, 0, sizeof(schedTasks));
+  for (i = 0U; i < count; i++)
+  {
+    schedTasks[i].pConfig = &pTable[i];
+    schedTasks[i].nextUs = now + pTable[i].periodUs;
+  }
+  schedCount = count;
+  schedIdle = (idle != NULL) ? idle : Sched_DefaultIdle;
+  schedEvents = 0U;
+  Sched_ResetStats();
+  return HAL_OK;
+}
+
+/**
+  * @brief  Sets event flags, callable from any interrupt level.
+  * @param  events: flags to set
+  * @retval None
+  */
+void Sched_Signal(uint32_t events)
+{
+  uint32_t primask = __get_PRIMASK();
+
+  __disable_irq();
+  schedEvents |= events;
+  __set_PRIMASK(primask);
+}
+
+/**
+  * @brief  Clears and returns the given event flags.
+  * @param  mask: flags to take
+  * @retval the flags of mask that were set
+  */
+static uint32_t Sched_Take(uint32_t mask)
+{
+  uint32_t events;
+
+  __disable_irq();
+  events = schedEvents & mask;
+  schedEvents &= ~mask;
+  __enable_irq();
+  return events;
+}
+
+/**
+  * @brief  Runs the released task with the earliest deadline, or the idle
+  *         hook when nothing is released. Call it from the main loop.
+  * @retval None
+  */
+void Sched_RunOnce(void)
+{
+  uint32_t now = Timebase_Us();
+  uint32_t pending = schedEvents;
+  uint32_t untilUs = 0xFFFFFFFFU;
+  Sched_Task_t *pBest = NULL;
+  uint32_t bestDeadline = 0U;
+  uint32_t start, runtime, events;
+  uint8_t i;
+
+  for (i = 0U; i < schedCount; i++)
+  {
+    Sched_Task_t *pTask = &schedTasks[i];
+    const Sched_TaskConfig_t *pConfig = pTask->pConfig;
+    uint8_t due = (pConfig->periodUs != 0U) && ((int32_t)(now - pTask->nextUs) >= 0);
+    uint32_t deadline;
+
+    if (!pTask->released && (due || ((pending & pConfig->events) != 0U)))
+    {
+      pTask->released = 1U;
+      pTask->releaseUs = due ? pTask->nextUs : now;
+    }
+    if (!pTask->released)
+    {
+      if ((pConfig->periodUs != 0U) && ((pTask->nextUs - now) < untilUs))
+      {
+        untilUs = pTask->nextUs - now;
+      }
+      continue;
+    }
+    deadline = pTask->releaseUs + pConfig->deadlineUs;
+    if ((pBest == NULL) || ((int32_t)(deadline - bestDeadline) < 0))
+    {
+      pBest = pTask;
+      bestDeadline = deadline;
+    }
+  }
+
+  if (pBest == NULL)
+  {
+    start = Timebase_Us();
+    schedIdle(untilUs);
+    schedStats.idleUs += Timebase_Us() - start;
+    return;
+  }
+
+  events = Sched_Take(pBest->pConfig->events);
+  if ((pBest->pConfig->periodUs != 0U) && ((int32_t)(now - pBest->nextUs) >= 0))
+  {
+    /* a late task is not run back to back to catch up */
+    pBest->nextUs += pBest->pConfig->periodUs;
+    if ((int32_t)(now - pBest->nextUs) >= 0)
+    {
+      pBest->nextUs = now + pBest->pConfig->periodUs;
+    }
+  }
+  pBest->released = 0U;
+
+  start = Timebase_Us();
+  if ((start - pBest->releaseUs) > schedStats.maxLatencyUs)
+  {
+    schedStats.maxLatencyUs = start - pBest->releaseUs;
+  }
+  pBest->pConfig->run(events);
+  now = Timebase_Us();
+  runtime = now - start;
+
+  pBest->runs++;
+  pBest->totalUs += runtime;
+  if (runtime > pBest->maxUs)
+  {
+    pBest->maxUs = runtime;
+  }
+  if ((pBest->pConfig->budgetUs != 0U) && (runtime > pBest->pConfig->budgetUs))
+  {
+    pBest->overruns++;
+  }
+  if ((int32_t)(now - bestDeadline) > 0)
+  {
+    pBest->misses++;
+  }
+}
+
+/**
+  * @brief  Clears the per task counters and starts a new idle window.
+  * @retval None
+  */
+void Sched_ResetStats(void)
+{
+  uint8_t i;
+
+  for (i = 0U; i < schedCount; i++)
+  {
+    schedTasks[i].runs = 0U;
+    schedTasks[i].maxUs = 0U;
+    schedTasks[i].totalUs = 0U;
+    schedTasks[i].overruns = 0U;
+    schedTasks[i].misses = 0U;
+  }
+  memset(&schedStats, 0, sizeof(schedStats));
+  schedStats.windowStartUs = Timebase_Us();
+}
+
+/**
+  * @brief  Number of tasks in the table.
+  * @retval task count
+  */
+uint8_t Sched_TaskCount(void)
+{
+  return schedCount;
+}
+
+/**
+  * @brief  "SCH,<window us>,<idle us>,<idle per mille>,<sleeps>,<max release latency us>"
+  * @param  buf: output buffer
+  * @param  len: buffer size
+  * @retval what snprintf returns
+  */
+int Sched_Format(char *buf, size_t len)
+{
+  uint32_t window = Timebase_Us() - schedStats.windowStartUs;
+  uint32_t idle = (window != 0U) ? (uint32_t)(((uint64_t)schedStats.idleUs * 1000U) / window) : 0U;
+
+  return snprintf(buf, len, "SCH,%lu,%lu,%lu,%lu,%lu\r\n", (unsigned long)window,
+                  (unsigned long)schedStats.idleUs, (unsigned long)idle,
+                  (unsigned long)schedStats.sleeps, (unsigned long)schedStats.maxLatencyUs);
+}
+
+/**
+  * @brief  "TSK,<name>,<runs>,<max us>,<avg us>,<budget us>,<overruns>,<misses>"
+  * @param  buf: output buffer
+  * @param  len: buffer size
+  * @param  index: task index in the table
+  * @retval what snprintf returns, 0 for an unknown index
+  */
+int Sched_TaskFormat(char *buf, size_t len, uint8_t index)
+{
+  const Sched_Task_t *pTask;
+
+  if (index >= schedCount)
+  {
+    return 0;
+  }
+  pTask = &schedTasks[index];
+  return snprintf(buf, len, "TSK,%s,%lu,%lu,%lu,%lu,%lu,%lu\r\n", pTask->pConfig->name,
+                  (unsigned long)pTask->runs, (unsigned long)pTask->maxUs,
+                  (unsigned long)((pTask->runs != 0U) ? (pTask->totalUs / pTask->runs) : 0U),
+                  (unsigned long)pTask->pConfig->budgetUs,
+                  (unsigned long)pTask->overruns, (unsigned long)pTask->misses);
+}
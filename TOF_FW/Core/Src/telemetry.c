@@ -0,0 +1,136 @@
+/**
+  ******************************************************************************
+  * @file    telemetry.c
+  * @brief   Line based telemetry over USART2.
+  *
+  *          Records are queued and sent by the USART2 transmit interrupt,
+  *          so a sender never waits for the line. A record that does not
+  *          fit in the queue is dropped whole and counted.
+  ******************************************************************************
+  */
+
+#include "telemetry.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+extern UART_HandleTypeDef huart2;
+
+uint32_t telemetryDropped;
+
+static char telemetryLine[TELEMETRY_LINE_MAX];
+static uint8_t telemetryTx[TELEMETRY_TX_SIZE];
+static volatile uint16_t txHead;   /* next free byte, main context */
+static volatile uint16_t txTail;   /* first unsent byte, transmit interrupt */
+static volatile uint16_t txLen;    /* bytes of the transfer in flight, 0 = idle */
+
+/**
+  * @brief  Starts the next contiguous chunk if the UART is idle.
+  *         Runs with the USART2 interrupt masked or from it.
+  * @retval None
+  */
+static void Telemetry_Kick(void)
+{
+  uint16_t head = txHead;
+  uint16_t tail = txTail;
+  uint16_t len;
+
+  if ((txLen != 0U) || (head == tail))
+  {
+    return;
+  }
+  len = (head > tail) ? (uint16_t)(head - tail) : (uint16_t)(TELEMETRY_TX_SIZE - tail);
+  txLen = len;
+  if (HAL_UART_Transmit_IT(&huart2, &telemetryTx[tail], len) != HAL_OK)
+  {
+    txLen = 0U;
+  }
+}
+
+/**
+  * @brief  Formats one record and queues it.
+  * @param  fmt: printf format, the caller adds the trailing "\r\n"
+  * @retval None
+  */
+void Telemetry_Send(const char *fmt, ...)
+{
+  va_list args;
+  uint16_t head, used, first;
+  uint32_t primask;
+  int len;
+
+  va_start(args, fmt);
+  len = vsnprintf(telemetryLine, sizeof(telemetryLine), fmt, args);
+  va_end(args);
+
+  if (len <= 0)
+  {
+    return;
+  }
+  if (len >= (int)sizeof(telemetryLine))
+  {
+    len = sizeof(telemetryLine) - 1;
+  }
+
+  head = txHead;
+  used = (uint16_t)((head + TELEMETRY_TX_SIZE - txTail) % TELEMETRY_TX_SIZE);
+  if ((uint16_t)len > (TELEMETRY_TX_SIZE - 1U - used))
+  {
+    telemetryDropped++;
+    return;
+  }
+  first = (uint16_t)(TELEMETRY_TX_SIZE - head);
+  if (first > (uint16_t)len)
+  {
+    first = (uint16_t)len;
+  }
+  memcpy(&telemetryTx[head], telemetryLine, first);
+  memcpy(telemetryTx, &telemetryLine[first], (uint16_t)len - first);
+
+  primask = __get_PRIMASK();
+  __disable_irq();
+  txHead = (uint16_t)((head + len) % TELEMETRY_TX_SIZE);
+  Telemetry_Kick();
+  __set_PRIMASK(primask);
+}
+
+/**
+  * @brief  Transmit complete callback, sends the rest of the queue.
+  * @param  huart: UART that finished
+  * @retval None
+  */
+void Telemetry_TxComplete(UART_HandleTypeDef *huart)
+{
+  if (huart != &huart2)
+  {
+    return;
+  }
+  txTail = (uint16_t)((txTail + txLen) % TELEMETRY_TX_SIZE);
+  txLen = 0U;
+  Telemetry_Kick();
+}
+
+/**
+  * @brief  Waits until the queue is empty and the last byte has left the
+  *         shift register, needed before the clocks are stopped.
+  * @retval None
+  */
+void Telemetry_Flush(void)
+{
+  uint32_t start = HAL_GetTick();
+  uint16_t tail = txTail;
+
+  while ((txHead != txTail) || (txLen != 0U) ||
+         (__HAL_UART_GET_FLAG(&huart2, UART_FLAG_TC) == RESET))
+  {
+    if (txTail != tail)
+    {
+      tail = txTail;
+      start = HAL_GetTick();
+    }
+    if ((HAL_GetTick() - start) > TELEMETRY_TIMEOUT_MS)
+    {
+      break;
+    }
+  }
+}
@@ -0,0 +1,115 @@
+/**
+  ******************************************************************************
+  * @file    timebase.c
+  * @brief   Microsecond timebase on TIM2 and per stage latency histograms.
+  *
+  *          TIM2 counts at 1 MHz over 16 bits, the update interrupt extends
+  *          it to 32 bits (wraps after 71 minutes). Stamps are taken on the
+  *          GPIO1 edge and around the readout, the differences go into log2
+  *          histograms reported as "LAT" telemetry records.
+  ******************************************************************************
+  */
+
+#include "timebase.h"
+#include "telemetry.h"
+#include <string.h>
+
+extern TIM_HandleTypeDef htim2;
+
+Latency_Hist_t latencyHist[LATENCY_STAGES];
+
+static volatile uint32_t timebaseHigh;
+
+/**
+  * @brief  Starts the free running counter and its overflow interrupt.
+  * @retval None
+  */
+void Timebase_Start(void)
+{
+  timebaseHigh = 0U;
+  HAL_TIM_Base_Start_IT(&htim2);
+}
+
+/**
+  * @brief  Current time in us. Safe from any interrupt level: an overflow
+  *         that is pending but not yet serviced is accounted for here.
+  * @retval Microseconds since Timebase_Start()
+  */
+uint32_t Timebase_Us(void)
+{
+  uint32_t primask = __get_PRIMASK();
+  uint32_t high;
+  uint32_t count;
+
+  __disable_irq();
+  high = timebaseHigh;
+  count = TIM2->CNT;
+  if ((__HAL_TIM_GET_FLAG(&htim2, TIM_FLAG_UPDATE) != RESET) && (count < 0x8000U))
+  {
+    high += 0x10000U;
+  }
+  __set_PRIMASK(primask);
+  return high + count;
+}
+
+/**
+  * @brief  TIM2 update, called from HAL_TIM_PeriodElapsedCallback().
+  * @retval None
+  */
+void Timebase_Overflow(void)
+{
+  timebaseHigh += 0x10000U;
+}
+
+static void Latency_Add(Latency_Hist_t *pHist, uint32_t us)
+{
+  uint32_t bin = 32U - __CLZ(us);
+
+  if (bin >= LATENCY_BINS)
+  {
+    bin = LATENCY_BINS - 1U;
+  }
+  if (pHist->bin[bin] != 0xFFFFU)
+  {
+    pHist->bin[bin]++;
+  }
+  pHist->count++;
+  if (us > pHist->maxUs)
+  {
+    pHist->maxUs = us;
+  }
+}
+
+/**
+  * @brief  Adds one sample's stamps to the stage histograms.
+  * @param  pStamp: stamps of the sample, all from Timebase_Us()
+  * @retval None
+  */
+void Latency_Record(const Timebase_Stamp_t *pStamp)
+{
+  Latency_Add(&latencyHist[LATENCY_IRQ_TO_READ], pStamp->readStartUs - pStamp->irqUs);
+  Latency_Add(&latencyHist[LATENCY_READOUT], pStamp->readEndUs - pStamp->readStartUs);
+  Latency_Add(&latencyHist[LATENCY_IRQ_TO_DONE], pStamp->readEndUs - pStamp->irqUs);
+}
+
+/**
+  * @brief  Sends one "LAT,<stage>,<count>,<max us>,<bin 0>..<bin 15>" record
+  *         per stage and starts new histograms.
+  * @retval None
+  */
+void Latency_Report(void)
+{
+  uint32_t stage;
+
+  for (stage = 0U; stage < LATENCY_STAGES; stage++)
+  {
+    const uint16_t *b = latencyHist[stage].bin;
+
+    Telemetry_Send("LAT,%lu,%lu,%lu,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u\r\n",
+                   (unsigned long)stage, (unsigned long)latencyHist[stage].count,
+                   (unsigned long)latencyHist[stage].maxUs,
+                   b[0], b[1], b[2], b[3], b[4], b[5], b[6], b[7],
+                   b[8], b[9], b[10], b[11], b[12], b[13], b[14], b[15]);
+  }
+  memset(latencyHist, 0, sizeof(latencyHist));
+}
@@ -630,7 +630,6 @@ typedef uint16_t VL53L1_TuningParms;
 /** @} end of VL53L1_TuningParms_group */
 
 
-#endif
 
 
 
@@ -9,6 +9,7 @@
 #define VL53L1X_H_
 
 #include "vl53l1x_api.h"
+#include "vl53l1x_fixpoint.h"
 #include "main.h"
 //detection mode
 #define DEFAULT_MODE   0	//default,see manul 5.3.1
@@ -19,7 +20,8 @@
  extern "C" {
 #endif
 //param struct for vl53l1x mode option, in manual 6.2
-typedef __packed struct
+//limits are 16.16, build them with FIX1616_CONST() and print them with fix1616Format()
+typedef struct __packed
 {
 	FixPoint1616_t signalLimit;    //Signal,related to reflected amplitude
 	FixPoint1616_t sigmaLimit;     //Sigmal, related to distance mm
@@ -0,0 +1,106 @@
+/*
+ * vl53l1x_budget.c
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: dkupe
+ */
+
+#include "vl53l1x_budget.h"
+
+const uint32_t budgetDefaultList[BUDGET_CACHE_MAX] = {15000, 20000, 33000, 50000, 100000, 200000};
+
+static void capture(VL53L1_Dev_t* pDev, budget_entry *pEntry, uint32_t budgetUs)
+{
+	VL53L1_LLDriverData_t *pLL = VL53L1DevStructGetLLDriverHandle(pDev);
+	const VL53L1_timing_config_t *pCfg = &pLL->tim_cfg;
+
+	pEntry->budgetUs = budgetUs;
+	pEntry->phasecalTimeoutUs = pLL->phasecal_config_timeout_us;
+	pEntry->mmTimeoutUs = pLL->mm_config_timeout_us;
+	pEntry->rangeTimeoutUs = pLL->range_config_timeout_us;
+	pEntry->phasecalMacrop = pLL->gen_cfg.phasecal_config__timeout_macrop;
+	pEntry->mmA[0] = pCfg->mm_config__timeout_macrop_a_hi;
+	pEntry->mmA[1] = pCfg->mm_config__timeout_macrop_a_lo;
+	pEntry->mmB[0] = pCfg->mm_config__timeout_macrop_b_hi;
+	pEntry->mmB[1] = pCfg->mm_config__timeout_macrop_b_lo;
+	pEntry->rangeA[0] = pCfg->range_config__timeout_macrop_a_hi;
+	pEntry->rangeA[1] = pCfg->range_config__timeout_macrop_a_lo;
+	pEntry->rangeB[0] = pCfg->range_config__timeout_macrop_b_hi;
+	pEntry->rangeB[1] = pCfg->range_config__timeout_macrop_b_lo;
+}
+
+static void restore(VL53L1_Dev_t* pDev, const budget_entry *pEntry)
+{
+	VL53L1_LLDriverData_t *pLL = VL53L1DevStructGetLLDriverHandle(pDev);
+	VL53L1_timing_config_t *pCfg = &pLL->tim_cfg;
+
+	pLL->phasecal_config_timeout_us = pEntry->phasecalTimeoutUs;
+	pLL->mm_config_timeout_us = pEntry->mmTimeoutUs;
+	pLL->range_config_timeout_us = pEntry->rangeTimeoutUs;
+	pLL->gen_cfg.phasecal_config__timeout_macrop = pEntry->phasecalMacrop;
+	pCfg->mm_config__timeout_macrop_a_hi = pEntry->mmA[0];
+	pCfg->mm_config__timeout_macrop_a_lo = pEntry->mmA[1];
+	pCfg->mm_config__timeout_macrop_b_hi = pEntry->mmB[0];
+	pCfg->mm_config__timeout_macrop_b_lo = pEntry->mmB[1];
+	pCfg->range_config__timeout_macrop_a_hi = pEntry->rangeA[0];
+	pCfg->range_config__timeout_macrop_a_lo = pEntry->rangeA[1];
+	pCfg->range_config__timeout_macrop_b_hi = pEntry->rangeB[0];
+	pCfg->range_config__timeout_macrop_b_lo = pEntry->rangeB[1];
+	VL53L1_SETPARAMETERFIELD(pDev, MeasurementTimingBudgetMicroSeconds, pEntry->budgetUs);
+}
+
+//call after the preset is applied. budgets the current distance mode rejects are
+//skipped, the device ends up with the budget it had before
+VL53L1_Error VL53BudgetCacheBuild(VL53L1_Dev_t* pDev, budget_cache *pCache, uint8_t preset,
+		const uint32_t *pBudgets, uint8_t count)
+{
+	VL53L1_Error Status;
+	const VL53L1_timing_config_t *pCfg = &VL53L1DevStructGetLLDriverHandle(pDev)->tim_cfg;
+	budget_entry current;
+	uint32_t budget;
+	uint8_t i;
+
+	memset(pCache, 0, sizeof(*pCache));
+	pCache->preset = BUDGET_PRESET_NONE;
+	if (count > BUDGET_CACHE_MAX)
+		count = BUDGET_CACHE_MAX;
+	Status = VL53L1_GetMeasurementTimingBudgetMicroSeconds(pDev, &budget);
+	if (Status != VL53L1_ERROR_NONE)
+		return Status;
+	capture(pDev, &current, budget);
+	pCache->preset = preset;
+	pCache->vcselA = pCfg->range_config__vcsel_period_a;
+	pCache->vcselB = pCfg->range_config__vcsel_period_b;
+
+	for (i = 0; i < count; i++)
+	{
+		if (VL53L1_SetMeasurementTimingBudgetMicroSeconds(pDev, pBudgets[i]) != VL53L1_ERROR_NONE)
+			continue;
+		capture(pDev, &pCache->entry[pCache->count++], pBudgets[i]);
+	}
+	restore(pDev, &current);
+	return VL53L1_ERROR_NONE;
+}
+
+//preset is the one the device runs now
+VL53L1_Error VL53BudgetSet(VL53L1_Dev_t* pDev, budget_cache *pCache, uint8_t preset, uint32_t budgetUs)
+{
+	const VL53L1_timing_config_t *pCfg = &VL53L1DevStructGetLLDriverHandle(pDev)->tim_cfg;
+	uint8_t i;
+
+	if (preset == pCache->preset && pCfg->range_config__vcsel_period_a == pCache->vcselA &&
+			pCfg->range_config__vcsel_period_b == pCache->vcselB)
+	{
+		for (i = 0; i < pCache->count; i++)
+		{
+			if (pCache->entry[i].budgetUs == budgetUs)
+			{
+				restore(pDev, &pCache->entry[i]);
+				pCache->hits++;
+				return VL53L1_ERROR_NONE;
+			}
+		}
+	}
+	pCache->misses++;
+	return VL53L1_SetMeasurementTimingBudgetMicroSeconds(pDev, budgetUs);
+}
@@ -0,0 +1,64 @@
+/*
+ * vl53l1x_budget.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: dkupe
+ */
+
+#ifndef VL53L1X_BUDGET_H_
+#define VL53L1X_BUDGET_H_
+
+#include "vl53l1x_api.h"
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+//VL53L1_SetMeasurementTimingBudgetMicroSeconds() turns the budget into macro periods
+//with 32 bit divides by fast_osc_frequency and the VCSEL period. the result only depends
+//on the device, the distance mode and the budget, so VL53BudgetCacheBuild() runs it
+//once per budget and keeps the encoded registers; VL53BudgetSet() then only copies.
+//the cache is tied to the preset and the VCSEL periods it was built with, with another
+//preset or after a distance mode change VL53BudgetSet() falls back to the API until the
+//cache is rebuilt.
+
+#ifndef BUDGET_CACHE_MAX
+#define BUDGET_CACHE_MAX   6
+#endif
+#define BUDGET_PRESET_NONE 0xFF	//empty cache, matches no preset
+
+typedef struct
+{
+	uint32_t budgetUs;
+	uint32_t phasecalTimeoutUs;
+	uint32_t mmTimeoutUs;
+	uint32_t rangeTimeoutUs;
+	uint8_t  phasecalMacrop;
+	uint8_t  mmA[2];           //hi, lo
+	uint8_t  mmB[2];
+	uint8_t  rangeA[2];
+	uint8_t  rangeB[2];
+}budget_entry;
+
+typedef struct
+{
+	budget_entry entry[BUDGET_CACHE_MAX];
+	uint8_t  count;
+	uint8_t  preset;           //DEFAULT_MODE..HIGH_SPEED the entries were computed for
+	uint8_t  vcselA;           //periods the entries were computed for
+	uint8_t  vcselB;
+	uint32_t hits;
+	uint32_t misses;
+}budget_cache;
+
+extern const uint32_t budgetDefaultList[BUDGET_CACHE_MAX];
+
+VL53L1_Error VL53BudgetCacheBuild(VL53L1_Dev_t* pDev, budget_cache *pCache, uint8_t preset,
+		const uint32_t *pBudgets, uint8_t count);
+VL53L1_Error VL53BudgetSet(VL53L1_Dev_t* pDev, budget_cache *pCache, uint8_t preset, uint32_t budgetUs);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VL53L1X_BUDGET_H_ */
@@ -0,0 +1,90 @@
+/*
+ * vl53l1x_busrecover.c
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: dkupe
+ */
+
+#include "vl53l1x_busrecover.h"
+#include "IOI2C.h"
+
+//half an SCL period at 100kHz, busy wait, the tick is far too coarse
+static void halfPeriod(void)
+{
+	volatile uint32_t n = SystemCoreClock / 800000;
+
+	while (n--)
+		;
+}
+
+static void pinsToGpio(void)
+{
+	GPIO_InitTypeDef GPIO_InitStruct = {0};
+
+	SCL_H;
+	SDA_H;
+	GPIO_InitStruct.Pin = VL53_SCL_Pin | VL53_SDA_Pin;
+	GPIO_InitStruct.Mode = GPIO_MODE_OUTPUT_OD;
+	GPIO_InitStruct.Pull = GPIO_NOPULL;
+	GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_HIGH;
+	HAL_GPIO_Init(GPIOB, &GPIO_InitStruct);
+}
+
+//idle bus has both lines high, IDR reads the pins in AF mode as well
+uint8_t VL53BusStuck(void)
+{
+	return SCL_read == GPIO_PIN_SET && SDA_read == GPIO_PIN_RESET;
+}
+
+VL53L1_Error VL53BusRecover(VL53L1_Dev_t* pDev)
+{
+	I2C_HandleTypeDef *hi2c = pDev->I2cHandle;
+	uint8_t i;
+
+	if (hi2c)
+		HAL_I2C_DeInit(hi2c);
+	pinsToGpio();
+	halfPeriod();
+
+	//the slave shifts out the rest of its byte, SDA goes high on the NACK slot
+	for (i = 0; i < BUSRECOVER_MAX_CLOCKS && SDA_read == GPIO_PIN_RESET; i++)
+	{
+		SCL_L;
+		halfPeriod();
+		SCL_H;
+		halfPeriod();
+	}
+	//STOP: SDA rising while SCL is high
+	SCL_L;
+	halfPeriod();
+	SDA_L;
+	halfPeriod();
+	SCL_H;
+	halfPeriod();
+	SDA_H;
+	halfPeriod();
+
+	if (SDA_read == GPIO_PIN_RESET)
+		return VL53L1_ERROR_CONTROL_INTERFACE;
+
+	if (hi2c == NULL)
+	{
+		IIC_Init();
+		return VL53L1_ERROR_NONE;
+	}
+	//the F1 I2C can keep BUSY latched from the glitch (errata 2.13.7), reset the cell.
+	//HAL_I2C_DeInit() gated its clock, the register writes need it back
+	__HAL_RCC_I2C1_CLK_ENABLE();
+	hi2c->Instance->CR1 |= I2C_CR1_SWRST;
+	hi2c->Instance->CR1 &= ~I2C_CR1_SWRST;
+	if (HAL_I2C_Init(hi2c) != HAL_OK)
+		return VL53L1_ERROR_CONTROL_INTERFACE;
+	return VL53L1_ERROR_NONE;
+}
+
+VL53L1_Error VL53BusResume(VL53L1_Dev_t* pDev)
+{
+	VL53L1_LLDriverData_t *pLL = VL53L1DevStructGetLLDriverHandle(pDev);
+
+	return VL53L1_init_and_start_range(pDev, pLL->measurement_mode, VL53L1_DEVICECONFIGLEVEL_FULL);
+}
@@ -0,0 +1,37 @@
+/*
+ * vl53l1x_busrecover.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: dkupe
+ */
+
+#ifndef VL53L1X_BUSRECOVER_H_
+#define VL53L1X_BUSRECOVER_H_
+
+#include "vl53l1x_api.h"
+#include "vl53l1x_api_core.h"
+#include "main.h"
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+//stuck bus: a reset MCU or a glitch left the sensor in the middle of a read, holding SDA
+//low and waiting for clocks. VL53BusRecover() takes the pins over as open drain GPIO,
+//clocks SCL until SDA is released (max 9), sends a STOP and gives the pins back to I2C1
+//(or to the bit-bang layer when the device has no I2C handle).
+//the sensor kept its registers and the driver its cache, so VL53BusResume() only writes
+//the cached configuration back and restarts the measurement mode that was running,
+//no DataInit/StaticInit. both together take well under a millisecond plus the I2C writes.
+
+#define BUSRECOVER_MAX_CLOCKS   9
+
+uint8_t VL53BusStuck(void);
+VL53L1_Error VL53BusRecover(VL53L1_Dev_t* pDev);
+VL53L1_Error VL53BusResume(VL53L1_Dev_t* pDev);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VL53L1X_BUSRECOVER_H_ */
@@ -0,0 +1,139 @@
+/*
+ * vl53l1x_calpipe.c
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: dkupe
+ */
+
+#include "vl53l1x_calpipe.h"
+
+static void progress(cali_pipeline *pPipe, uint8_t stage)
+{
+	const cali_config *pConfig = pPipe->pConfig;
+	uint8_t done = 0, i;
+
+	for (i = 0; i < CALI_STAGE_COUNT; i++)
+		if (pPipe->finished & CALI_STAGE_BIT(i))
+			done++;
+	if (pConfig->onProgress)
+		pConfig->onProgress(stage, done * 100 / CALI_STAGE_COUNT, pPipe->status);
+}
+
+static uint8_t nextStage(const cali_pipeline *pPipe)
+{
+	uint8_t stage;
+
+	for (stage = 0; stage < CALI_STAGE_COUNT; stage++)
+	{
+		if (pPipe->finished & CALI_STAGE_BIT(stage))
+			continue;
+		if (stage == CALI_STAGE_COMMIT || (pPipe->pConfig->stages & CALI_STAGE_BIT(stage)))
+			return stage;
+	}
+	return CALI_STAGE_DONE;
+}
+
+//out of spec parts stop the sequence right away, no point running the next stage
+static VL53L1_Error checkLimits(const cali_config *pConfig, uint8_t stage, const VL53L1_CalibrationData_t *pData)
+{
+	const VL53L1_CustomerNvmManaged_t *pCustomer = &pData->customer;
+	int16_t offsetMm;
+
+	switch (stage)
+	{
+	case CALI_STAGE_REFSPAD:
+		if ((pConfig->minRefSpads && pCustomer->ref_spad_man__num_requested_ref_spads < pConfig->minRefSpads) ||
+				(pConfig->maxRefSpads && pCustomer->ref_spad_man__num_requested_ref_spads > pConfig->maxRefSpads))
+			return VL53L1_ERROR_REF_SPAD_INIT;
+		break;
+	case CALI_STAGE_OFFSET:
+		//11.2 format
+		offsetMm = pCustomer->algo__part_to_part_range_offset_mm / 4;
+		if (pConfig->maxOffsetMm && (offsetMm > pConfig->maxOffsetMm || offsetMm < -pConfig->maxOffsetMm))
+			return VL53L1_ERROR_RANGE_ERROR;
+		break;
+	case CALI_STAGE_XTALK:
+		if (pConfig->maxXtalkPlaneOffset &&
+				pCustomer->algo__crosstalk_compensation_plane_offset_kcps > pConfig->maxXtalkPlaneOffset)
+			return VL53L1_ERROR_XTALK_EXTRACTION_SIGMA_LIMIT_FAIL;
+		break;
+	default:
+		break;
+	}
+	return VL53L1_ERROR_NONE;
+}
+
+void VL53CaliPipeInit(cali_pipeline *pPipe, const cali_config *pConfig)
+{
+	memset(pPipe, 0, sizeof(*pPipe));
+	pPipe->pConfig = pConfig;
+	pPipe->stage = nextStage(pPipe);
+}
+
+//pPipe holds what was saved before the interruption, the results of the finished
+//stages are pushed back to the device before the remaining ones run
+VL53L1_Error VL53CaliPipeResume(VL53L1_Dev_t* pDev, cali_pipeline *pPipe, const cali_config *pConfig)
+{
+	VL53L1_Error Status = VL53L1_ERROR_NONE;
+
+	pPipe->pConfig = pConfig;
+	pPipe->status = VL53L1_ERROR_NONE;
+	if (pPipe->finished)
+		Status = VL53L1_SetCalibrationData(pDev, &pPipe->data);
+	pPipe->stage = (Status == VL53L1_ERROR_NONE) ? nextStage(pPipe) : CALI_STAGE_ABORTED;
+	pPipe->status = Status;
+	return Status;
+}
+
+uint8_t VL53CaliPipeStep(VL53L1_Dev_t* pDev, cali_pipeline *pPipe)
+{
+	const cali_config *pConfig = pPipe->pConfig;
+	uint8_t stage = pPipe->stage;
+	VL53L1_Error Status = VL53L1_ERROR_NONE;
+
+	if (stage >= CALI_STAGE_COUNT)
+		return stage;
+	if (pConfig->targetReady && !pConfig->targetReady(stage))
+		return stage;
+
+	switch (stage)
+	{
+	case CALI_STAGE_REFSPAD:
+		Status = VL53L1_PerformRefSpadManagement(pDev);
+		break;
+	case CALI_STAGE_OFFSET:
+		Status = VL53L1_PerformOffsetSimpleCalibration(pDev, pConfig->offsetDistanceMm);
+		break;
+	case CALI_STAGE_XTALK:
+		Status = VL53L1_PerformSingleTargetXTalkCalibration(pDev, pConfig->xtalkDistanceMm);
+		break;
+	default:
+		break;
+	}
+
+	//the device side copy is the reference, keep ours in sync after every stage
+	if (Status == VL53L1_ERROR_NONE)
+		Status = VL53L1_GetCalibrationData(pDev, &pPipe->data);
+	if (Status == VL53L1_ERROR_NONE)
+		Status = checkLimits(pConfig, stage, &pPipe->data);
+	if (Status == VL53L1_ERROR_NONE && stage == CALI_STAGE_COMMIT && pConfig->store)
+		Status = pConfig->store(&pPipe->data);
+
+	pPipe->status = Status;
+	if (Status != VL53L1_ERROR_NONE)
+	{
+		pPipe->stage = CALI_STAGE_ABORTED;
+		progress(pPipe, stage);
+		return pPipe->stage;
+	}
+	pPipe->finished |= CALI_STAGE_BIT(stage);
+	pPipe->stage = nextStage(pPipe);
+	progress(pPipe, stage);
+	return pPipe->stage;
+}
+
+void VL53CaliPipeAbort(cali_pipeline *pPipe, VL53L1_Error reason)
+{
+	pPipe->status = reason;
+	pPipe->stage = CALI_STAGE_ABORTED;
+}
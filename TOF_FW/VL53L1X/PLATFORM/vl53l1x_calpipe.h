@@ -0,0 +1,68 @@
+/*
+ * vl53l1x_calpipe.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: dkupe
+ */
+
+#ifndef VL53L1X_CALPIPE_H_
+#define VL53L1X_CALPIPE_H_
+
+#include "vl53l1x_api.h"
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+//ref SPAD -> offset -> xtalk -> commit as one resumable sequence, order as in UM2133.
+//VL53CaliPipeStep() runs at most one stage per call and returns, so the caller keeps
+//its loop (UART, fixture IO, other sensors) alive between stages. the finished stage
+//mask and the calibration data survive in cali_pipeline, a pipeline interrupted by a
+//power cycle continues with VL53CaliPipeResume().
+//the preset and distance mode used for offset/xtalk are the ones the caller set up.
+
+#define CALI_STAGE_REFSPAD     0
+#define CALI_STAGE_OFFSET      1
+#define CALI_STAGE_XTALK       2
+#define CALI_STAGE_COMMIT      3
+#define CALI_STAGE_COUNT       4
+#define CALI_STAGE_DONE        0xFE
+#define CALI_STAGE_ABORTED     0xFF
+
+#define CALI_STAGE_BIT(stage)  ((uint8_t)1 << (stage))
+#define CALI_ALL_STAGES        0x0F
+
+typedef struct
+{
+	uint8_t  stages;               //CALI_STAGE_BIT mask of stages to run, commit is always run
+	int32_t  offsetDistanceMm;     //target distance for the offset stage
+	int32_t  xtalkDistanceMm;      //target distance for the xtalk stage
+	uint8_t  minRefSpads;          //limits, 0 = unchecked
+	uint8_t  maxRefSpads;
+	int16_t  maxOffsetMm;          //|part to part offset|
+	uint32_t maxXtalkPlaneOffset;  //raw algo__crosstalk_compensation_plane_offset_kcps
+	//fixture hooks, any of them may be NULL
+	uint8_t (*targetReady)(uint8_t stage);     //0 = not yet, stage is retried on the next step
+	void (*onProgress)(uint8_t stage, uint8_t percent, VL53L1_Error status);
+	VL53L1_Error (*store)(const VL53L1_CalibrationData_t *pData);   //commit, e.g. flash write
+}cali_config;
+
+typedef struct
+{
+	const cali_config *pConfig;
+	uint8_t  stage;                //next stage to run, or DONE/ABORTED
+	uint8_t  finished;             //CALI_STAGE_BIT mask of passed stages
+	VL53L1_Error status;           //last stage result, reason for an abort
+	VL53L1_CalibrationData_t data;
+}cali_pipeline;
+
+void VL53CaliPipeInit(cali_pipeline *pPipe, const cali_config *pConfig);
+VL53L1_Error VL53CaliPipeResume(VL53L1_Dev_t* pDev, cali_pipeline *pPipe, const cali_config *pConfig);
+uint8_t VL53CaliPipeStep(VL53L1_Dev_t* pDev, cali_pipeline *pPipe);
+void VL53CaliPipeAbort(cali_pipeline *pPipe, VL53L1_Error reason);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VL53L1X_CALPIPE_H_ */
@@ -0,0 +1,166 @@
+/*
+ * vl53l1x_collision.c
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: dkupe
+ */
+
+#include "vl53l1x_collision.h"
+#include "vl53l1x_api_core.h"
+#include "vl53l1x_xfer.h"
+#include "vl53l1x_fixpoint.h"
+#include <stdio.h>
+
+volatile uint32_t collisionEntryCycles;
+
+//RESULT__RANGE_STATUS bits 4:0
+#define COLLISION_STATUS_MASK  0x1F
+
+static uint8_t rangeValid(uint8_t status)
+{
+	return status == VL53L1_DEVICEERROR_RANGECOMPLETE ||
+			status == VL53L1_DEVICEERROR_RANGECOMPLETE_NO_WRAP_CHECK ||
+			status == VL53L1_DEVICEERROR_RANGECOMPLETE_MERGED_PULSE;
+}
+
+//a transfer the interrupt preempted is still between its start and stop, or a DMA is queued
+static uint8_t busBusy(I2C_HandleTypeDef *hi2c)
+{
+	return hi2c->State != HAL_I2C_STATE_READY || __HAL_I2C_GET_FLAG(hi2c, I2C_FLAG_BUSY);
+}
+
+static void record(collision_state *pState, uint32_t cycles)
+{
+	uint32_t limit = COLLISION_HIST_BASE_US * pState->cyclesPerUs;
+	uint8_t bin = 0;
+
+	while (bin < COLLISION_HIST_BINS - 1 && cycles >= limit)
+	{
+		limit <<= 1;
+		bin++;
+	}
+	pState->hist[bin]++;
+	pState->lastCycles = cycles;
+	if (cycles < pState->minCycles)
+		pState->minCycles = cycles;
+	if (cycles > pState->maxCycles)
+		pState->maxCycles = cycles;
+}
+
+static void check(collision_state *pState, uint32_t entryCycles)
+{
+	VL53L1_Dev_t *pDev = pState->pDev;
+	uint8_t status, range[2];
+	uint8_t near = pState->near;
+	int32_t mm;
+
+	if (VL53XferReadPolled(pDev->I2cHandle, pDev->I2cDevAddr, VL53L1_RESULT__RANGE_STATUS, &status, 1) != VL53L1_ERROR_NONE ||
+		VL53XferReadPolled(pDev->I2cHandle, pDev->I2cDevAddr, VL53L1_RESULT__FINAL_CROSSTALK_CORRECTED_RANGE_MM_SD0,
+				range, 2) != VL53L1_ERROR_NONE)
+	{
+		//no answer from the sensor, fail to the safe side
+		pState->failed++;
+		near = 1;
+	}
+	else
+	{
+		status &= COLLISION_STATUS_MASK;
+		mm = (int16_t)((range[0] << 8) | range[1]);
+		if (mm > 0)
+			mm = fix16Mul((uint16_t)mm, pState->gain, FIX111_FRAC_BITS);
+		pState->lastStatus = status;
+		pState->lastMm = (int16_t)mm;
+		if (!rangeValid(status))
+			pState->invalid++;
+		else if (mm < pState->nearMm)
+			near = 1;
+		else if (mm > pState->clearMm)
+			near = 0;
+	}
+	pState->port->BSRR = near ? pState->pin : (uint32_t)pState->pin << 16;
+	record(pState, DWT->CYCCNT - entryCycles);
+	if (near && !pState->near)
+		pState->asserts++;
+	pState->near = near;
+	pState->checks++;
+}
+
+//the output pin has to be configured as push pull output already, it starts released.
+//ranging must be running, the gain factor is taken from the loaded calibration
+VL53L1_Error VL53CollisionInit(VL53L1_Dev_t* pDev, collision_state *pState, GPIO_TypeDef *port,
+		uint16_t pin, uint16_t nearMm, uint16_t clearMm)
+{
+	VL53L1_LLDriverData_t *pLL = VL53L1DevStructGetLLDriverHandle(pDev);
+
+	if (nearMm == 0 || clearMm <= nearMm)
+		return VL53L1_ERROR_INVALID_PARAMS;
+	memset(pState, 0, sizeof(*pState));
+	pState->pDev = pDev;
+	pState->port = port;
+	pState->pin = pin;
+	pState->nearMm = nearMm;
+	pState->clearMm = clearMm;
+	pState->gain = pLL->gain_cal.standard_ranging_gain_factor;
+	if (pState->gain == 0)
+		pState->gain = VL53L1_GAIN_FACTOR__STANDARD_DEFAULT;
+	pState->cyclesPerUs = SystemCoreClock / 1000000;
+	pState->minCycles = 0xFFFFFFFF;
+	port->BSRR = (uint32_t)pin << 16;
+
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+	return VL53L1_ERROR_NONE;
+}
+
+//GPIO1 interrupt, before anything else touches the frame
+void VL53CollisionIsr(collision_state *pState)
+{
+	uint32_t entryCycles = collisionEntryCycles;
+
+	if (pState->pDev == NULL)
+		return;
+	if (busBusy(pState->pDev->I2cHandle))
+	{
+		pState->entryCycles = entryCycles;
+		pState->deferred = 1;
+		pState->defers++;
+		return;
+	}
+	check(pState, entryCycles);
+}
+
+//main loop, finishes a check the interrupt could not do, before the frame is read out
+void VL53CollisionService(collision_state *pState)
+{
+	if (!pState->deferred)
+		return;
+	pState->deferred = 0;
+	check(pState, pState->entryCycles);
+}
+
+static unsigned long tenthsUs(const collision_state *pState, uint32_t cycles)
+{
+	return (unsigned long)(((uint64_t)cycles * 10 + (pState->cyclesPerUs >> 1)) / pState->cyclesPerUs);
+}
+
+//CLW,near,checks,asserts,defers,invalid,failed,last us,min us,max us,hist[0..7]
+//latencies in 0.1us, min/max reset each report
+int VL53CollisionFormat(char *buf, size_t len, collision_state *pState)
+{
+	uint32_t minCycles = pState->maxCycles ? pState->minCycles : 0;
+	int n, i;
+
+	if (pState->cyclesPerUs == 0)
+		return snprintf(buf, len, "CLW,off\r\n");
+	n = snprintf(buf, len, "CLW,%u,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu", pState->near,
+			(unsigned long)pState->checks, (unsigned long)pState->asserts, (unsigned long)pState->defers,
+			(unsigned long)pState->invalid, (unsigned long)pState->failed, tenthsUs(pState, pState->lastCycles),
+			tenthsUs(pState, minCycles), tenthsUs(pState, pState->maxCycles));
+	for (i = 0; i < COLLISION_HIST_BINS && n > 0 && (size_t)n < len; i++)
+		n += snprintf(buf + n, len - n, ",%lu", (unsigned long)pState->hist[i]);
+	if (n > 0 && (size_t)n < len)
+		n += snprintf(buf + n, len - n, "\r\n");
+	pState->minCycles = 0xFFFFFFFF;
+	pState->maxCycles = 0;
+	return n;
+}
@@ -0,0 +1,73 @@
+/*
+ * vl53l1x_collision.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: dkupe
+ */
+
+#ifndef VL53L1X_COLLISION_H_
+#define VL53L1X_COLLISION_H_
+
+#include "vl53l1x_api.h"
+#include "main.h"
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+//collision warning fast path: runs inside the GPIO1 interrupt, reads only the range
+//status and the final range (two polled transfers, 11 bytes on the wire) and drives
+//the stop output before the main loop has seen the frame. near below nearMm asserts,
+//only a valid range above clearMm releases, anything else keeps the current state.
+//if the bus is in use by a transfer the interrupt preempted, the check is deferred to
+//VL53CollisionService() in the main loop.
+//latency is counted in core cycles with the DWT counter, from the EXTI handler entry
+//(VL53CollisionEntry()) to the output write.
+
+#define COLLISION_HIST_BINS     8	//latency histogram, bin n = below base << n, last bin = rest
+#define COLLISION_HIST_BASE_US  64	//~11 bytes at 100kHz lands in the 1-2ms bin
+
+typedef struct
+{
+	VL53L1_Dev_t *pDev;
+	GPIO_TypeDef *port;             //stop output, push pull, high = stop
+	uint16_t pin;
+	uint16_t nearMm;                //assert below
+	uint16_t clearMm;               //release above, > nearMm
+	uint16_t gain;                  //ranging gain correction, 1.11, the API applies it too
+	volatile uint8_t near;
+	volatile uint8_t deferred;      //bus was busy, check pending for the main loop
+	uint8_t  lastStatus;            //device range status of the last check
+	int16_t  lastMm;
+	uint32_t entryCycles;           //EXTI entry of the deferred check
+	uint32_t cyclesPerUs;
+	uint32_t lastCycles;            //entry to output of the last check
+	uint32_t minCycles;
+	uint32_t maxCycles;
+	uint32_t hist[COLLISION_HIST_BINS];
+	uint32_t checks;
+	uint32_t asserts;
+	uint32_t defers;
+	uint32_t invalid;               //status not a completed range
+	uint32_t failed;                //readout not acknowledged
+}collision_state;
+
+extern volatile uint32_t collisionEntryCycles;
+
+//first statement of the EXTI handler
+static inline void VL53CollisionEntry(void)
+{
+	collisionEntryCycles = DWT->CYCCNT;
+}
+
+VL53L1_Error VL53CollisionInit(VL53L1_Dev_t* pDev, collision_state *pState, GPIO_TypeDef *port,
+		uint16_t pin, uint16_t nearMm, uint16_t clearMm);
+void VL53CollisionIsr(collision_state *pState);
+void VL53CollisionService(collision_state *pState);
+int VL53CollisionFormat(char *buf, size_t len, collision_state *pState);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VL53L1X_COLLISION_H_ */
@@ -0,0 +1,102 @@
+/*
+ * vl53l1x_continuous.c
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: dkupe
+ */
+
+#include "vl53l1x_continuous.h"
+#include <stdio.h>
+
+VL53L1_Error VL53ContinuousStart(VL53L1_Dev_t* pDev, continuous_state *pState)
+{
+	memset(pState, 0, sizeof(*pState));
+	pState->minPeriodUs = 0xFFFFFFFF;
+	return VL53L1_init_and_start_range(pDev, VL53L1_DEVICEMEASUREMENTMODE_BACKTOBACK,
+			VL53L1_DEVICECONFIGLEVEL_FULL);
+}
+
+VL53L1_Error VL53ContinuousStop(VL53L1_Dev_t* pDev)
+{
+	return VL53L1_StopMeasurement(pDev);
+}
+
+static void measurePeriod(continuous_state *pState, uint32_t frameUs, uint8_t gap)
+{
+	uint32_t periodUs = (frameUs - pState->lastUs) / gap;
+
+	pState->periodSumUs += periodUs;
+	pState->periods++;
+	if (periodUs < pState->minPeriodUs)
+		pState->minPeriodUs = periodUs;
+	if (periodUs > pState->maxPeriodUs)
+		pState->maxPeriodUs = periodUs;
+}
+
+//call on GPIO1 (or when VL53L1_GetMeasurementDataReady says so), frameUs is the capture
+//time of the frame, the interrupt time when there was one
+VL53L1_Error VL53ContinuousService(VL53L1_Dev_t* pDev, continuous_state *pState, uint32_t frameUs)
+{
+	VL53L1_Error Status;
+	uint8_t back = pState->front ^ 1;
+	VL53L1_RangingMeasurementData_t *pData = &pState->slot[back];
+	uint8_t gap;
+
+	Status = VL53L1_GetRangingMeasurementData(pDev, pData);
+	//the device keeps ranging on its own, releasing the result buffer is all that is left.
+	//no ClearInterruptAndStartMeasurement here, it would rewrite the dynamic config
+	if (Status == VL53L1_ERROR_NONE)
+		Status = VL53L1_WrByte(pDev, VL53L1_SYSTEM__INTERRUPT_CLEAR, 0x01);
+	if (Status != VL53L1_ERROR_NONE)
+		return Status;
+
+	if (pData->RangeStatus == VL53L1_RANGESTATUS_SYNCRONISATION_INT)
+	{
+		pState->syncDropped++;
+		pState->lastStream = pData->StreamCount;
+		return VL53L1_ERROR_NONE;
+	}
+	//stream count wraps 255 -> 128
+	if (pState->frames != 0)
+	{
+		gap = (uint8_t)(pData->StreamCount - pState->lastStream);
+		if (pData->StreamCount < pState->lastStream)
+			gap -= 128;
+		if (gap > 1)
+			pState->missed += gap - 1;
+		if (gap > 0)
+			measurePeriod(pState, frameUs, gap);
+	}
+	pState->lastStream = pData->StreamCount;
+	pState->lastUs = frameUs;
+	pState->frames++;
+	pState->front = back;
+	pState->fresh = 1;
+	return VL53L1_ERROR_NONE;
+}
+
+//latest complete frame, returns 1 if it was not read before
+uint8_t VL53ContinuousGet(continuous_state *pState, VL53L1_RangingMeasurementData_t *pData)
+{
+	uint8_t fresh = pState->fresh;
+
+	*pData = pState->slot[pState->front];
+	pState->fresh = 0;
+	return fresh;
+}
+
+//CNT,frames,sync dropped,missed,mean period us,min us,max us
+//period statistics reset each report
+int VL53ContinuousFormat(char *buf, size_t len, continuous_state *pState)
+{
+	int n = snprintf(buf, len, "CNT,%lu,%lu,%lu,%lu,%lu,%lu\r\n", (unsigned long)pState->frames,
+			(unsigned long)pState->syncDropped, (unsigned long)pState->missed,
+			(unsigned long)(pState->periods ? pState->periodSumUs / pState->periods : 0),
+			(unsigned long)(pState->maxPeriodUs ? pState->minPeriodUs : 0), (unsigned long)pState->maxPeriodUs);
+
+	pState->periodSumUs = 0;
+	pState->periods = 0;
+	pState->minPeriodUs = 0xFFFFFFFF;
+	pState->maxPeriodUs = 0;
+	return n;
+}
@@ -0,0 +1,53 @@
+/*
+ * vl53l1x_continuous.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: dkupe
+ */
+
+#ifndef VL53L1X_CONTINUOUS_H_
+#define VL53L1X_CONTINUOUS_H_
+
+#include "vl53l1x_api.h"
+#include "vl53l1x_api_core.h"
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+//back to back ranging: the device starts frame N+1 as soon as frame N is done, the
+//host only has to read N and clear the interrupt before N+1 ends. the clear is a single
+//byte written right after the result block read, everything else (status mapping,
+//filters, telemetry) runs while N+1 integrates. results land in two slots, the reader
+//always gets the last complete frame while the other slot is being filled.
+//the first interrupt after start is the synchronisation frame and is dropped.
+//the frame period is measured from the capture times passed to VL53ContinuousService(),
+//a gap of lost frames counts as that many periods.
+
+typedef struct
+{
+	VL53L1_RangingMeasurementData_t slot[2];
+	volatile uint8_t front;        //slot holding the latest complete frame
+	volatile uint8_t fresh;        //front not read yet
+	uint8_t  lastStream;
+	uint32_t frames;
+	uint32_t syncDropped;
+	uint32_t missed;               //frames lost to a late clear, from StreamCount
+	uint32_t lastUs;               //capture time of the last frame
+	uint32_t periodSumUs;          //since the last report
+	uint32_t periods;
+	uint32_t minPeriodUs;
+	uint32_t maxPeriodUs;
+}continuous_state;
+
+VL53L1_Error VL53ContinuousStart(VL53L1_Dev_t* pDev, continuous_state *pState);
+VL53L1_Error VL53ContinuousStop(VL53L1_Dev_t* pDev);
+VL53L1_Error VL53ContinuousService(VL53L1_Dev_t* pDev, continuous_state *pState, uint32_t frameUs);
+uint8_t VL53ContinuousGet(continuous_state *pState, VL53L1_RangingMeasurementData_t *pData);
+int VL53ContinuousFormat(char *buf, size_t len, continuous_state *pState);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VL53L1X_CONTINUOUS_H_ */
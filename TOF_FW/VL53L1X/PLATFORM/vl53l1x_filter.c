@@ -0,0 +1,203 @@
+/*
+ * vl53l1x_filter.c
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: dkupe
+ */
+
+#include "vl53l1x_filter.h"
+#include "vl53l1x_fixpoint.h"
+
+#define FILTER_Q4_MAX_SIGMA   0x3FFF       //1023mm, keeps sigma^2 + P00 inside int32
+#define FILTER_P_MAX          0x3FFFFFFF
+#define FILTER_P_INIT_VEL     (2500 << 8)  //(50mm/frame)^2, velocity unknown on lock
+
+const filter_config filterDefaultConfig =
+{
+	.mode         = FILTER_MEDIAN_KALMAN,
+	.medianWindow = 5,
+	.maxRejects   = 3,
+	.statusMask   = FILTER_DEFAULT_STATUS_MASK,
+	.gateMm       = 150,
+	.accelNoise   = 100 << 8,
+	.minSigmaMm   = 1,
+};
+
+static int32_t clampCov(int64_t value, int32_t min)
+{
+	if (value > FILTER_P_MAX)
+		return FILTER_P_MAX;
+	if (value < min)
+		return min;
+	return (int32_t)value;
+}
+
+//median of the valid samples in the ring, window is small so insertion sort is fine
+static int16_t medianOf(const filter_state *pFilter)
+{
+	int16_t sorted[FILTER_MEDIAN_MAX];
+	uint8_t n = pFilter->count;
+	uint8_t i, j;
+
+	for (i = 0; i < n; i++)
+	{
+		int16_t v = pFilter->history[i];
+		for (j = i; j > 0 && sorted[j - 1] > v; j--)
+			sorted[j] = sorted[j - 1];
+		sorted[j] = v;
+	}
+	return sorted[n >> 1];
+}
+
+static void kalmanLock(filter_state *pFilter, int32_t zQ4, int32_t r)
+{
+	pFilter->pos = zQ4;
+	pFilter->vel = 0;
+	pFilter->p00 = r;
+	pFilter->p01 = 0;
+	pFilter->p11 = FILTER_P_INIT_VEL;
+	pFilter->locked = 1;
+}
+
+//constant velocity model, dt = one frame, white acceleration noise
+static void kalmanPredict(filter_state *pFilter)
+{
+	int32_t q = pFilter->pConfig->accelNoise;
+	int32_t p01 = pFilter->p01;
+	int32_t p11 = pFilter->p11;
+
+	pFilter->pos += pFilter->vel;
+	pFilter->p00 = clampCov((int64_t)pFilter->p00 + 2 * (int64_t)p01 + p11 + (q >> 2), 1);
+	pFilter->p01 = clampCov((int64_t)p01 + p11 + (q >> 1), -FILTER_P_MAX);
+	pFilter->p11 = clampCov((int64_t)p11 + q, 1);
+}
+
+static void kalmanCorrect(filter_state *pFilter, int32_t zQ4, int32_t r)
+{
+	int32_t s = pFilter->p00 + r;
+	int32_t a = pFilter->p00;
+	int32_t b = pFilter->p01;
+	int32_t k0, k1, y;
+	int32_t p00 = pFilter->p00;
+	int32_t p01 = pFilter->p01;
+
+	//bring S under 16 bit so the Q15 gains need a single 32 bit divide each
+	while (s > 0xFFFF)
+	{
+		s >>= 1;
+		a >>= 1;
+		b >>= 1;
+	}
+	if (b > s)
+		b = s;
+	else if (b < -s)
+		b = -s;
+	k0 = (a << 15) / s;
+	k1 = (b * 32768) / s;
+
+	y = zQ4 - pFilter->pos;
+	pFilter->pos += (int32_t)(((int64_t)k0 * y) >> 15);
+	pFilter->vel += (int32_t)(((int64_t)k1 * y) >> 15);
+
+	pFilter->p00 = clampCov(p00 - (((int64_t)k0 * p00) >> 15), 1);
+	pFilter->p01 = clampCov(p01 - (((int64_t)k0 * p01) >> 15), -FILTER_P_MAX);
+	pFilter->p11 = clampCov(pFilter->p11 - (((int64_t)k1 * p01) >> 15), 1);
+}
+
+void VL53FilterInit(filter_state *pFilter, const filter_config *pConfig)
+{
+	pFilter->pConfig = pConfig ? pConfig : &filterDefaultConfig;
+	VL53FilterReset(pFilter);
+}
+
+void VL53FilterReset(filter_state *pFilter)
+{
+	const filter_config *pConfig = pFilter->pConfig;
+
+	memset(pFilter, 0, sizeof(*pFilter));
+	pFilter->pConfig = pConfig;
+}
+
+uint8_t VL53FilterUpdate(filter_state *pFilter,
+		const VL53L1_RangingMeasurementData_t *pData, int32_t *pDistance)
+{
+	const filter_config *pConfig = pFilter->pConfig;
+	uint8_t useKalman = (pConfig->mode == FILTER_KALMAN) || (pConfig->mode == FILTER_MEDIAN_KALMAN);
+	uint8_t useMedian = (pConfig->mode == FILTER_MEDIAN) || (pConfig->mode == FILTER_MEDIAN_KALMAN);
+	uint8_t window = pConfig->medianWindow;
+	int32_t z = pData->RangeMilliMeter;
+	int32_t sigma, r;
+
+	if (useKalman && pFilter->locked)
+		kalmanPredict(pFilter);
+
+	if (pData->RangeStatus > 15 || !(pConfig->statusMask & FILTER_STATUS_BIT(pData->RangeStatus)))
+		goto reject;
+
+	if (useMedian)
+	{
+		if (window == 0 || window > FILTER_MEDIAN_MAX)
+			window = FILTER_MEDIAN_MAX;
+		pFilter->history[pFilter->head] = (int16_t)z;
+		pFilter->head = (pFilter->head + 1 == window) ? 0 : pFilter->head + 1;
+		if (pFilter->count < window)
+			pFilter->count++;
+		z = medianOf(pFilter);
+	}
+
+	if (!useKalman)
+	{
+		pFilter->rejects = 0;
+		*pDistance = z;
+		return FILTER_OK;
+	}
+
+	sigma = (int32_t)fixSat16(fixRescale(pData->SigmaMilliMeter, FIX1616_FRAC_BITS, 4));
+	if (sigma < (int32_t)pConfig->minSigmaMm << 4)
+		sigma = (int32_t)pConfig->minSigmaMm << 4;
+	if (sigma > FILTER_Q4_MAX_SIGMA)
+		sigma = FILTER_Q4_MAX_SIGMA;
+	r = sigma * sigma;
+	if (r < (1 << 8))
+		r = 1 << 8;
+
+	if (!pFilter->locked)
+	{
+		kalmanLock(pFilter, z << 4, r);
+	}
+	else
+	{
+		int32_t innovation = (z << 4) - pFilter->pos;
+		int32_t gate = (int32_t)pConfig->gateMm << 4;
+		uint8_t outside = (gate != 0) && (innovation > gate || innovation < -gate);
+
+		if (outside && pFilter->rejects < pConfig->maxRejects)
+			goto reject;
+		//gated too often in a row, the target really moved
+		if (outside)
+			kalmanLock(pFilter, z << 4, r);
+		else
+			kalmanCorrect(pFilter, z << 4, r);
+	}
+	pFilter->rejects = 0;
+	*pDistance = (pFilter->pos + 8) >> 4;
+	return FILTER_OK;
+
+reject:
+	if (pFilter->rejects < 0xFF)
+		pFilter->rejects++;
+	//no usable frame for too long, coasting on the old velocity is worse than nothing
+	if (useKalman && pFilter->locked && pFilter->rejects > pConfig->maxRejects)
+		pFilter->locked = 0;
+	if (useKalman && pFilter->locked)
+	{
+		*pDistance = (pFilter->pos + 8) >> 4;
+		return FILTER_REJECTED;
+	}
+	if (!useKalman && pFilter->count != 0)
+	{
+		*pDistance = medianOf(pFilter);
+		return FILTER_REJECTED;
+	}
+	return FILTER_NO_DATA;
+}
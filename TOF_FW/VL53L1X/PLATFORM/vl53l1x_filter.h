@@ -0,0 +1,77 @@
+/*
+ * vl53l1x_filter.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: dkupe
+ */
+
+#ifndef VL53L1X_FILTER_H_
+#define VL53L1X_FILTER_H_
+
+#include "vl53l1x_def.h"
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+//post-processing stage run on every VL53L1_GetRangingMeasurementData() result.
+//integer only, one filter_state per sensor, config may be shared between sensors.
+
+//filter mode
+#define FILTER_NONE            0	//status rejection only
+#define FILTER_MEDIAN          1	//sliding median over the last valid frames
+#define FILTER_KALMAN          2	//constant velocity kalman, weighted by SigmaMilliMeter
+#define FILTER_MEDIAN_KALMAN   3	//median feeds the kalman
+
+#define FILTER_MEDIAN_MAX      9	//max median window, keep odd
+
+//VL53FilterUpdate() result
+#define FILTER_OK              0	//measurement accepted, output updated
+#define FILTER_REJECTED        1	//measurement dropped, output is the prediction
+#define FILTER_NO_DATA         2	//nothing accepted yet, output not valid
+
+//bit n set = RangeStatus n accepted (statuses above 15 are always rejected)
+#define FILTER_STATUS_BIT(status)   ((uint16_t)1 << (status))
+#define FILTER_DEFAULT_STATUS_MASK  (FILTER_STATUS_BIT(VL53L1_RANGESTATUS_RANGE_VALID) | \
+                                     FILTER_STATUS_BIT(VL53L1_RANGESTATUS_RANGE_VALID_NO_WRAP_CHECK_FAIL) | \
+                                     FILTER_STATUS_BIT(VL53L1_RANGESTATUS_RANGE_VALID_MERGED_PULSE))
+
+typedef struct
+{
+	uint8_t  mode;            //FILTER_xxx
+	uint8_t  medianWindow;    //1..FILTER_MEDIAN_MAX, odd
+	uint8_t  maxRejects;      //consecutive gated frames before the kalman re-locks on the new target
+	uint8_t  reserved;
+	uint16_t statusMask;      //accepted RangeStatus values, see FILTER_STATUS_BIT
+	uint16_t gateMm;          //innovation gate in mm, 0 = no gating
+	uint16_t accelNoise;      //kalman process noise, (mm/frame^2)^2 in Q8
+	uint16_t minSigmaMm;      //floor applied to SigmaMilliMeter, mm
+}filter_config;
+
+typedef struct
+{
+	const filter_config *pConfig;
+	int32_t  pos;             //mm, Q4
+	int32_t  vel;             //mm/frame, Q4
+	int32_t  p00;             //covariance, mm^2 Q8
+	int32_t  p01;
+	int32_t  p11;
+	int16_t  history[FILTER_MEDIAN_MAX];
+	uint8_t  head;
+	uint8_t  count;           //valid samples in history
+	uint8_t  rejects;         //consecutive gated frames
+	uint8_t  locked;          //kalman initialised
+}filter_state;
+
+extern const filter_config filterDefaultConfig;
+
+void VL53FilterInit(filter_state *pFilter, const filter_config *pConfig);
+void VL53FilterReset(filter_state *pFilter);
+uint8_t VL53FilterUpdate(filter_state *pFilter,
+		const VL53L1_RangingMeasurementData_t *pData, int32_t *pDistance);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VL53L1X_FILTER_H_ */
@@ -0,0 +1,177 @@
+/*
+ * vl53l1x_fixpoint.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: dkupe
+ */
+
+#ifndef VL53L1X_FIXPOINT_H_
+#define VL53L1X_FIXPOINT_H_
+
+#include "vl53l1x_types.h"
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+//integer only fixed point helpers for the formats the driver reports, so no value
+//has to go through float (every float op is a libgcc call with -mfloat-abi=soft).
+//the *_CONST macros are constant expressions and can be used in static tables.
+
+typedef uint16_t FixPoint97_t;    //rates in Mcps
+typedef uint16_t FixPoint511_t;   //phase, xtalk gradients
+typedef uint16_t FixPoint313_t;   //rate per SPAD
+
+#define FIX1616_FRAC_BITS  16
+#define FIX97_FRAC_BITS     7
+#define FIX511_FRAC_BITS   11
+#define FIX313_FRAC_BITS   13
+#define FIX142_FRAC_BITS    2   //sigma threshold register, mm
+#define FIX111_FRAC_BITS   11   //gain factors
+
+#define FIX1616_MAX  ((FixPoint1616_t)0xFFFFFFFF)
+#define FIX16_MAX    ((uint16_t)0xFFFF)
+
+//value = ip + milli/1000, rounded to the nearest step
+#define FIX_CONST(ip, milli, frac) \
+	((((uint32_t)(ip)) << (frac)) + ((((uint32_t)(milli)) << (frac)) + 500) / 1000)
+#define FIX1616_CONST(ip, milli)  ((FixPoint1616_t)FIX_CONST(ip, milli, FIX1616_FRAC_BITS))
+#define FIX97_CONST(ip, milli)    ((FixPoint97_t)FIX_CONST(ip, milli, FIX97_FRAC_BITS))
+#define FIX511_CONST(ip, milli)   ((FixPoint511_t)FIX_CONST(ip, milli, FIX511_FRAC_BITS))
+#define FIX313_CONST(ip, milli)   ((FixPoint313_t)FIX_CONST(ip, milli, FIX313_FRAC_BITS))
+
+//fixRescale() for constants, fraction bits can only be dropped, rounds to nearest
+#define FIX_RESCALE_CONST(value, fromFrac, toFrac) \
+	((((uint32_t)(value)) + ((uint32_t)1 << ((fromFrac) - (toFrac)) >> 1)) >> ((fromFrac) - (toFrac)))
+
+static inline uint32_t fixSat32(uint64_t value)
+{
+	return value > 0xFFFFFFFFu ? 0xFFFFFFFFu : (uint32_t)value;
+}
+
+static inline uint16_t fixSat16(uint32_t value)
+{
+	return value > 0xFFFFu ? 0xFFFFu : (uint16_t)value;
+}
+
+//change the number of fraction bits, rounding when bits are dropped, saturating when added
+static inline uint32_t fixRescale(uint32_t value, uint8_t fromFrac, uint8_t toFrac)
+{
+	if (toFrac >= fromFrac)
+		return fixSat32((uint64_t)value << (toFrac - fromFrac));
+	return (uint32_t)(((uint64_t)value + ((uint32_t)1 << (fromFrac - toFrac - 1))) >> (fromFrac - toFrac));
+}
+
+//16.16 arithmetic, all saturating
+static inline FixPoint1616_t fix1616Add(FixPoint1616_t a, FixPoint1616_t b)
+{
+	return fixSat32((uint64_t)a + b);
+}
+
+static inline FixPoint1616_t fix1616Sub(FixPoint1616_t a, FixPoint1616_t b)
+{
+	return a > b ? a - b : 0;
+}
+
+static inline FixPoint1616_t fix1616Mul(FixPoint1616_t a, FixPoint1616_t b)
+{
+	return fixSat32(((uint64_t)a * b + 0x8000) >> 16);
+}
+
+static inline FixPoint1616_t fix1616Div(FixPoint1616_t a, FixPoint1616_t b)
+{
+	if (b == 0)
+		return FIX1616_MAX;
+	return fixSat32((((uint64_t)a << 16) + (b >> 1)) / b);
+}
+
+static inline FixPoint1616_t fix1616FromInt(uint32_t value)
+{
+	return fixSat32((uint64_t)value << 16);
+}
+
+static inline FixPoint1616_t fix1616FromMilli(uint32_t milli)
+{
+	return fixSat32((((uint64_t)milli << 16) + 500) / 1000);
+}
+
+static inline uint32_t fix1616ToInt(FixPoint1616_t value)
+{
+	return (uint32_t)(((uint64_t)value + 0x8000) >> 16);
+}
+
+static inline uint32_t fix1616ToMilli(FixPoint1616_t value)
+{
+	return fixSat32(((uint64_t)value * 1000 + 0x8000) >> 16);
+}
+
+//16 bit device formats <-> 16.16
+static inline FixPoint1616_t fix97To1616(FixPoint97_t value)   { return (FixPoint1616_t)value << 9; }
+static inline FixPoint1616_t fix511To1616(FixPoint511_t value) { return (FixPoint1616_t)value << 5; }
+static inline FixPoint1616_t fix313To1616(FixPoint313_t value) { return (FixPoint1616_t)value << 3; }
+
+static inline FixPoint97_t fix1616To97(FixPoint1616_t value)
+{
+	return fixSat16(fixRescale(value, FIX1616_FRAC_BITS, FIX97_FRAC_BITS));
+}
+
+static inline FixPoint511_t fix1616To511(FixPoint1616_t value)
+{
+	return fixSat16(fixRescale(value, FIX1616_FRAC_BITS, FIX511_FRAC_BITS));
+}
+
+static inline FixPoint313_t fix1616To313(FixPoint1616_t value)
+{
+	return fixSat16(fixRescale(value, FIX1616_FRAC_BITS, FIX313_FRAC_BITS));
+}
+
+//16 bit device formats, saturating
+static inline uint16_t fix16Add(uint16_t a, uint16_t b)
+{
+	return fixSat16((uint32_t)a + b);
+}
+
+static inline uint16_t fix16Sub(uint16_t a, uint16_t b)
+{
+	return a > b ? a - b : 0;
+}
+
+static inline uint16_t fix16Mul(uint16_t a, uint16_t b, uint8_t frac)
+{
+	uint32_t round = frac ? (uint32_t)1 << (frac - 1) : 0;
+
+	return fixSat16(((uint32_t)a * b + round) >> frac);
+}
+
+//prints value with the given number of decimals (max 6) without touching float,
+//returns what snprintf returns
+static inline int fixFormat(char *buf, size_t len, uint32_t value, uint8_t frac, uint8_t decimals)
+{
+	static const uint32_t pow10[7] = {1, 10, 100, 1000, 10000, 100000, 1000000};
+	uint32_t ip, fp;
+
+	if (decimals > 6)
+		decimals = 6;
+	ip = value >> frac;
+	fp = (uint32_t)((((uint64_t)(value & (((uint32_t)1 << frac) - 1)) * pow10[decimals]) +
+			((uint64_t)1 << frac >> 1)) >> frac);
+	if (fp >= pow10[decimals])
+	{
+		fp -= pow10[decimals];
+		ip++;
+	}
+	if (decimals == 0)
+		return snprintf(buf, len, "%lu", (unsigned long)ip);
+	return snprintf(buf, len, "%lu.%0*lu", (unsigned long)ip, (int)decimals, (unsigned long)fp);
+}
+
+static inline int fix1616Format(char *buf, size_t len, FixPoint1616_t value, uint8_t decimals)
+{
+	return fixFormat(buf, len, value, FIX1616_FRAC_BITS, decimals);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VL53L1X_FIXPOINT_H_ */
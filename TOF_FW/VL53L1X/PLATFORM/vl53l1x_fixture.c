@@ -0,0 +1,177 @@
+/*
+ * vl53l1x_fixture.c
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: dkupe
+ */
+
+#include "vl53l1x_fixture.h"
+#include <stdio.h>
+
+#define FIXTURE_BOOT_MS   2	//tBOOT is 1.2ms
+
+static void emit(fixture_state *pFixture, uint8_t unit, VL53L1_Error Status)
+{
+	const fixture_config *pConfig = pFixture->pConfig;
+	VL53L1_Dev_t *pDev = pFixture->pUnits[unit].pDev;
+	fixture_record record;
+
+	memset(&record, 0, sizeof(record));
+	record.unit = unit;
+	record.address = pDev->I2cDevAddr;
+	record.samples = pFixture->taken[unit];
+	if (Status == VL53L1_ERROR_NONE && record.samples == 0)
+		Status = VL53L1_ERROR_RANGE_ERROR;
+	if (Status == VL53L1_ERROR_NONE)
+	{
+		record.meanMm = (int16_t)(pFixture->sum[unit] / record.samples);
+		record.offsetMm = (int16_t)pConfig->calDistanceMm - record.meanMm;
+		Status = VL53L1_GetCalibrationData(pDev, &record.data);
+	}
+	//same result as VL53L1_PerformOffsetSimpleCalibration, offset is 11.2
+	if (Status == VL53L1_ERROR_NONE)
+	{
+		record.data.customer.algo__part_to_part_range_offset_mm = record.offsetMm * 4;
+		record.data.customer.mm_config__inner_offset_mm = 0;
+		record.data.customer.mm_config__outer_offset_mm = 0;
+		Status = VL53L1_SetCalibrationData(pDev, &record.data);
+	}
+	record.status = Status;
+	pFixture->active &= ~((uint32_t)1 << unit);
+	if (pConfig->onRecord)
+		pConfig->onRecord(&record);
+}
+
+//all units must come up on FIXTURE_DEFAULT_ADDR, so only one may leave reset at a time
+VL53L1_Error VL53FixtureBringUp(const fixture_unit *pUnits, uint8_t count)
+{
+	VL53L1_Error Status = VL53L1_ERROR_NONE;
+	uint8_t i;
+
+	if (count > FIXTURE_UNITS_MAX)
+		return VL53L1_ERROR_INVALID_PARAMS;
+	for (i = 0; i < count; i++)
+		HAL_GPIO_WritePin(pUnits[i].xshutPort, pUnits[i].xshutPin, GPIO_PIN_RESET);
+	HAL_Delay(FIXTURE_BOOT_MS);
+
+	for (i = 0; i < count && Status == VL53L1_ERROR_NONE; i++)
+	{
+		VL53L1_Dev_t *pDev = pUnits[i].pDev;
+
+		HAL_GPIO_WritePin(pUnits[i].xshutPort, pUnits[i].xshutPin, GPIO_PIN_SET);
+		HAL_Delay(FIXTURE_BOOT_MS);
+		pDev->I2cDevAddr = FIXTURE_DEFAULT_ADDR;
+		Status = VL53L1_WaitDeviceBooted(pDev);
+		if (Status == VL53L1_ERROR_NONE && pUnits[i].address != FIXTURE_DEFAULT_ADDR)
+		{
+			Status = VL53L1_SetDeviceAddress(pDev, pUnits[i].address);
+			if (Status == VL53L1_ERROR_NONE)
+				pDev->I2cDevAddr = pUnits[i].address;
+		}
+		if (Status == VL53L1_ERROR_NONE)
+			Status = VL53L1_DataInit(pDev);
+		if (Status == VL53L1_ERROR_NONE)
+			Status = VL53L1_StaticInit(pDev);
+		//no ranging involved, short enough to stay sequential
+		if (Status == VL53L1_ERROR_NONE)
+			Status = VL53L1_PerformRefSpadManagement(pDev);
+	}
+	return Status;
+}
+
+//clears the offsets so the ranges come out uncorrected, then starts every unit
+VL53L1_Error VL53FixtureStart(fixture_state *pFixture, const fixture_config *pConfig,
+		const fixture_unit *pUnits, uint8_t count)
+{
+	VL53L1_Error Status = VL53L1_ERROR_NONE;
+	VL53L1_CalibrationData_t data;
+	uint8_t i;
+
+	if (count == 0 || count > FIXTURE_UNITS_MAX)
+		return VL53L1_ERROR_INVALID_PARAMS;
+	memset(pFixture, 0, sizeof(*pFixture));
+	pFixture->pConfig = pConfig;
+	pFixture->pUnits = pUnits;
+	pFixture->count = count;
+
+	for (i = 0; i < count; i++)
+	{
+		VL53L1_Dev_t *pDev = pUnits[i].pDev;
+
+		Status = VL53L1_GetCalibrationData(pDev, &data);
+		if (Status == VL53L1_ERROR_NONE)
+		{
+			data.customer.algo__part_to_part_range_offset_mm = 0;
+			data.customer.mm_config__inner_offset_mm = 0;
+			data.customer.mm_config__outer_offset_mm = 0;
+			Status = VL53L1_SetCalibrationData(pDev, &data);
+		}
+		if (Status == VL53L1_ERROR_NONE)
+			Status = VL53L1_StartMeasurement(pDev);
+		if (Status == VL53L1_ERROR_NONE)
+			pFixture->active |= (uint32_t)1 << i;
+		else
+			emit(pFixture, i, Status);
+	}
+	pFixture->phase = pFixture->active ? FIXTURE_OFFSET : FIXTURE_DONE;
+	return VL53L1_ERROR_NONE;
+}
+
+//one pass over the units, only the ones with a frame ready touch the bus for longer
+//than the data ready poll. returns the fixture phase
+uint8_t VL53FixtureService(fixture_state *pFixture)
+{
+	const fixture_config *pConfig = pFixture->pConfig;
+	VL53L1_RangingMeasurementData_t result;
+	uint8_t i, ready;
+
+	for (i = 0; i < pFixture->count; i++)
+	{
+		VL53L1_Dev_t *pDev = pFixture->pUnits[i].pDev;
+		VL53L1_Error Status;
+
+		if (!(pFixture->active & ((uint32_t)1 << i)))
+			continue;
+		ready = 0;
+		Status = VL53L1_GetMeasurementDataReady(pDev, &ready);
+		if (Status == VL53L1_ERROR_NONE && !ready)
+			continue;
+		if (Status == VL53L1_ERROR_NONE)
+			Status = VL53L1_GetRangingMeasurementData(pDev, &result);
+		if (Status == VL53L1_ERROR_NONE)
+		{
+			pFixture->frames[i]++;
+			if (pFixture->frames[i] > pConfig->warmUp &&
+					result.RangeStatus == VL53L1_RANGESTATUS_RANGE_VALID)
+			{
+				pFixture->sum[i] += result.RangeMilliMeter;
+				pFixture->taken[i]++;
+			}
+		}
+		if (Status == VL53L1_ERROR_NONE && pFixture->taken[i] < pConfig->samples &&
+				pFixture->frames[i] < pConfig->maxFrames)
+		{
+			Status = VL53L1_ClearInterruptAndStartMeasurement(pDev);
+			if (Status == VL53L1_ERROR_NONE)
+				continue;
+		}
+		VL53L1_StopMeasurement(pDev);
+		if (Status == VL53L1_ERROR_NONE && pFixture->taken[i] < pConfig->samples)
+			Status = VL53L1_ERROR_RANGE_ERROR;
+		emit(pFixture, i, Status);
+	}
+	if (!pFixture->active)
+		pFixture->phase = FIXTURE_DONE;
+	return pFixture->phase;
+}
+
+//one CSV line per unit: CAL,unit,addr,status,samples,mean,offset,spads,xtalk
+int VL53FixtureFormat(char *buf, size_t len, const fixture_record *pRecord)
+{
+	const VL53L1_CustomerNvmManaged_t *pCustomer = &pRecord->data.customer;
+
+	return snprintf(buf, len, "CAL,%u,0x%02X,%d,%u,%d,%d,%u,%lu\r\n",
+			pRecord->unit, pRecord->address, (int)pRecord->status, pRecord->samples,
+			pRecord->meanMm, pRecord->offsetMm, pCustomer->ref_spad_man__num_requested_ref_spads,
+			(unsigned long)pCustomer->algo__crosstalk_compensation_plane_offset_kcps);
+}
@@ -0,0 +1,85 @@
+/*
+ * vl53l1x_fixture.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: dkupe
+ */
+
+#ifndef VL53L1X_FIXTURE_H_
+#define VL53L1X_FIXTURE_H_
+
+#include "vl53l1x_api.h"
+#include "main.h"
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+//end of line calibration of several sensors sharing one I2C bus.
+//VL53FixtureBringUp() releases the units one by one from XSHUT and moves each to its
+//own address. the offset stage then ranges on all units at once: every unit integrates
+//on its own while the others are read out, so the stage costs about the time of one
+//unit instead of N. each finished unit produces one fixture_record.
+//every unit needs its own target at calDistanceMm, otherwise the VCSELs see each other.
+
+#ifndef FIXTURE_UNITS_MAX
+#define FIXTURE_UNITS_MAX   8
+#endif
+#define FIXTURE_DEFAULT_ADDR   0x52
+
+//fixture phase
+#define FIXTURE_IDLE       0
+#define FIXTURE_OFFSET     1	//interleaved ranging, call VL53FixtureService()
+#define FIXTURE_DONE       2
+
+typedef struct
+{
+	VL53L1_Dev_t *pDev;
+	GPIO_TypeDef *xshutPort;
+	uint16_t xshutPin;
+	uint8_t  address;          //8 bit address assigned at bring up
+}fixture_unit;
+
+typedef struct
+{
+	uint8_t  unit;
+	uint8_t  address;
+	VL53L1_Error status;
+	uint8_t  samples;          //valid frames averaged
+	int16_t  meanMm;           //uncorrected mean range
+	int16_t  offsetMm;         //applied part to part offset
+	VL53L1_CalibrationData_t data;
+}fixture_record;
+
+typedef struct
+{
+	uint16_t calDistanceMm;
+	uint8_t  samples;          //valid frames averaged per unit
+	uint8_t  warmUp;           //frames dropped after start
+	uint16_t maxFrames;        //frames before a unit gives up on getting enough valid ones
+	void (*onRecord)(const fixture_record *pRecord);
+}fixture_config;
+
+typedef struct
+{
+	const fixture_config *pConfig;
+	const fixture_unit *pUnits;
+	uint8_t  count;
+	uint8_t  phase;
+	uint32_t active;           //units still ranging
+	int32_t  sum[FIXTURE_UNITS_MAX];
+	uint8_t  taken[FIXTURE_UNITS_MAX];
+	uint16_t frames[FIXTURE_UNITS_MAX];
+}fixture_state;
+
+VL53L1_Error VL53FixtureBringUp(const fixture_unit *pUnits, uint8_t count);
+VL53L1_Error VL53FixtureStart(fixture_state *pFixture, const fixture_config *pConfig,
+		const fixture_unit *pUnits, uint8_t count);
+uint8_t VL53FixtureService(fixture_state *pFixture);
+int VL53FixtureFormat(char *buf, size_t len, const fixture_record *pRecord);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VL53L1X_FIXTURE_H_ */
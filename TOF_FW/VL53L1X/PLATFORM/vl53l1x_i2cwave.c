@@ -0,0 +1,301 @@
+/*
+ * vl53l1x_i2cwave.c
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: dkupe
+ */
+
+#include "vl53l1x_i2cwave.h"
+#include <string.h>
+
+#define SYM_0       0	//SDA low during the clock
+#define SYM_1       1	//SDA released, also every bit read from the slave
+#define SYM_START   2	//also repeated START
+#define SYM_STOP    3
+
+#define SET(pin)    ((uint32_t)(pin))
+#define RESET(pin)  ((uint32_t)(pin) << 16)
+
+#define WAVE_TIMEOUT_MS   10
+
+//the DMA callbacks carry no context, there is one engine
+static wave_bus *activeBus;
+
+static void putSym(wave_bus *pBus, uint8_t sym)
+{
+	uint16_t n = pBus->symCount++;
+
+	pBus->sym[n >> 2] |= sym << ((n & 3) * 2);
+}
+
+static uint8_t getSym(const wave_bus *pBus, uint16_t n)
+{
+	return (pBus->sym[n >> 2] >> ((n & 3) * 2)) & 3;
+}
+
+//8 bits and the slave's ACK slot
+static void putByte(wave_bus *pBus, uint8_t value)
+{
+	uint8_t i;
+
+	for (i = 0; i < 8; i++, value <<= 1)
+		putSym(pBus, (value & 0x80) ? SYM_1 : SYM_0);
+	pBus->ackCheck[pBus->symCount >> 3] |= 1 << (pBus->symCount & 7);
+	putSym(pBus, SYM_1);
+}
+
+static void beginProgram(wave_bus *pBus, uint8_t address, uint16_t index)
+{
+	memset(pBus->sym, 0, sizeof(pBus->sym));
+	memset(pBus->ackCheck, 0, sizeof(pBus->ackCheck));
+	memset(pBus->rx, 0, sizeof(pBus->rx));
+	pBus->symCount = 0;
+	pBus->readPos = 0;
+	putSym(pBus, SYM_START);
+	putByte(pBus, address & 0xFE);
+	putByte(pBus, (uint8_t)(index >> 8));
+	putByte(pBus, (uint8_t)index);
+}
+
+//one symbol is 4 ticks, SDA changes only while SCL is low except for START/STOP
+static void encodeSym(const wave_bus *pBus, uint8_t sym, uint32_t *pOut)
+{
+	uint32_t scl = pBus->sclPin;
+	uint32_t sda = pBus->sdaPin;
+
+	switch (sym)
+	{
+	case SYM_START:
+		pOut[0] = SET(sda);
+		pOut[1] = SET(scl);
+		pOut[2] = RESET(sda);
+		pOut[3] = RESET(scl);
+		break;
+	case SYM_STOP:
+		pOut[0] = RESET(sda);
+		pOut[1] = SET(scl);
+		pOut[2] = SET(sda);
+		pOut[3] = 0;
+		break;
+	default:
+		pOut[0] = sym == SYM_1 ? SET(sda) : RESET(sda);
+		pOut[1] = SET(scl);
+		pOut[2] = 0;
+		pOut[3] = RESET(scl);
+		break;
+	}
+}
+
+//fills one half of the out buffer, past the end of the program the lines stay as they are
+static void encodeChunk(wave_bus *pBus, uint8_t half)
+{
+	uint32_t *pOut = &pBus->out[half * WAVE_CHUNK_TICKS];
+	uint8_t i;
+
+	for (i = 0; i < WAVE_CHUNK_SYMS; i++, pOut += WAVE_TICKS_PER_SYM)
+	{
+		if (pBus->encoded < pBus->symCount)
+			encodeSym(pBus, getSym(pBus, pBus->encoded++), pOut);
+		else
+			memset(pOut, 0, WAVE_TICKS_PER_SYM * sizeof(uint32_t));
+	}
+}
+
+//the sample taken half a tick after the last word of a symbol sees SCL high for a full tick
+static void decodeChunk(wave_bus *pBus, uint8_t half)
+{
+	const uint16_t *pIn = &pBus->in[half * WAVE_CHUNK_TICKS];
+	uint8_t i;
+
+	for (i = 0; i < WAVE_CHUNK_SYMS && pBus->decoded < pBus->symCount; i++, pIn += WAVE_TICKS_PER_SYM)
+	{
+		if (pIn[WAVE_TICKS_PER_SYM - 1] & pBus->sdaPin)
+			pBus->rx[pBus->decoded >> 3] |= 1 << (pBus->decoded & 7);
+		pBus->decoded++;
+	}
+}
+
+static void stopEngine(wave_bus *pBus)
+{
+	__HAL_TIM_DISABLE(pBus->htim);
+	__HAL_TIM_DISABLE_DMA(pBus->htim, TIM_DMA_UPDATE | TIM_DMA_CC3);
+	HAL_DMA_Abort(pBus->hdmaOut);
+	HAL_DMA_Abort(pBus->hdmaIn);
+	pBus->busy = 0;
+}
+
+static void outHalf(DMA_HandleTypeDef *hdma)
+{
+	(void)hdma;
+	encodeChunk(activeBus, 0);
+}
+
+static void outFull(DMA_HandleTypeDef *hdma)
+{
+	(void)hdma;
+	encodeChunk(activeBus, 1);
+}
+
+static void inHalf(DMA_HandleTypeDef *hdma)
+{
+	(void)hdma;
+	decodeChunk(activeBus, 0);
+	if (activeBus->decoded >= activeBus->symCount)
+		stopEngine(activeBus);
+}
+
+static void inFull(DMA_HandleTypeDef *hdma)
+{
+	(void)hdma;
+	decodeChunk(activeBus, 1);
+	if (activeBus->decoded >= activeBus->symCount)
+		stopEngine(activeBus);
+}
+
+static VL53L1_Error run(wave_bus *pBus)
+{
+	TIM_HandleTypeDef *htim = pBus->htim;
+
+	pBus->encoded = 0;
+	pBus->decoded = 0;
+	encodeChunk(pBus, 0);
+	encodeChunk(pBus, 1);
+	pBus->busy = 1;
+
+	pBus->hdmaOut->XferHalfCpltCallback = outHalf;
+	pBus->hdmaOut->XferCpltCallback = outFull;
+	pBus->hdmaIn->XferHalfCpltCallback = inHalf;
+	pBus->hdmaIn->XferCpltCallback = inFull;
+	if (HAL_DMA_Start_IT(pBus->hdmaOut, (uint32_t)pBus->out, (uint32_t)&pBus->port->BSRR,
+			2 * WAVE_CHUNK_TICKS) != HAL_OK ||
+		HAL_DMA_Start_IT(pBus->hdmaIn, (uint32_t)&pBus->port->IDR, (uint32_t)pBus->in,
+			2 * WAVE_CHUNK_TICKS) != HAL_OK)
+	{
+		stopEngine(pBus);
+		return VL53L1_ERROR_CONTROL_INTERFACE;
+	}
+	__HAL_TIM_SET_COUNTER(htim, 0);
+	__HAL_TIM_SET_COMPARE(htim, TIM_CHANNEL_3, __HAL_TIM_GET_AUTORELOAD(htim) / 2);
+	__HAL_TIM_ENABLE_DMA(htim, TIM_DMA_UPDATE | TIM_DMA_CC3);
+	__HAL_TIM_ENABLE(htim);
+	return VL53L1_ERROR_NONE;
+}
+
+void VL53WaveInit(wave_bus *pBus, TIM_HandleTypeDef *htim, DMA_HandleTypeDef *hdmaOut,
+		DMA_HandleTypeDef *hdmaIn, GPIO_TypeDef *port, uint16_t sclPin, uint16_t sdaPin)
+{
+	GPIO_InitTypeDef GPIO_InitStruct = {0};
+
+	memset(pBus, 0, sizeof(*pBus));
+	pBus->htim = htim;
+	pBus->hdmaOut = hdmaOut;
+	pBus->hdmaIn = hdmaIn;
+	pBus->port = port;
+	pBus->sclPin = sclPin;
+	pBus->sdaPin = sdaPin;
+	activeBus = pBus;
+
+	port->BSRR = SET(sclPin | sdaPin);
+	GPIO_InitStruct.Pin = sclPin | sdaPin;
+	GPIO_InitStruct.Mode = GPIO_MODE_OUTPUT_OD;
+	GPIO_InitStruct.Pull = GPIO_NOPULL;
+	GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_HIGH;
+	HAL_GPIO_Init(port, &GPIO_InitStruct);
+}
+
+VL53L1_Error VL53WaveStartRead(wave_bus *pBus, uint8_t address, uint16_t index, uint16_t len)
+{
+	uint16_t i;
+	uint8_t bit;
+
+	if (pBus->busy || len == 0 || len > WAVE_BYTES_MAX)
+		return VL53L1_ERROR_INVALID_PARAMS;
+	beginProgram(pBus, address, index);
+	putSym(pBus, SYM_START);
+	putByte(pBus, address | 0x01);
+	pBus->readPos = pBus->symCount;
+	//slave drives the bits, master ACKs all but the last byte
+	for (i = 0; i < len; i++)
+	{
+		for (bit = 0; bit < 8; bit++)
+			putSym(pBus, SYM_1);
+		putSym(pBus, i + 1 < len ? SYM_0 : SYM_1);
+	}
+	putSym(pBus, SYM_STOP);
+	return run(pBus);
+}
+
+VL53L1_Error VL53WaveStartWrite(wave_bus *pBus, uint8_t address, uint16_t index, const uint8_t *pData, uint16_t len)
+{
+	uint16_t i;
+
+	if (pBus->busy || len > WAVE_BYTES_MAX)
+		return VL53L1_ERROR_INVALID_PARAMS;
+	beginProgram(pBus, address, index);
+	for (i = 0; i < len; i++)
+		putByte(pBus, pData[i]);
+	putSym(pBus, SYM_STOP);
+	return run(pBus);
+}
+
+//after busy dropped: any NACK fails the transfer, pData gets the read payload (may be NULL)
+VL53L1_Error VL53WaveResult(wave_bus *pBus, uint8_t *pData, uint16_t len)
+{
+	uint16_t n, i;
+	uint8_t bit, value;
+
+	if (pBus->busy)
+		return VL53L1_ERROR_TIME_OUT;
+	for (n = 0; n < pBus->symCount; n++)
+		if ((pBus->ackCheck[n >> 3] & pBus->rx[n >> 3]) & (1 << (n & 7)))
+			return VL53L1_ERROR_CONTROL_INTERFACE;
+	for (i = 0; pData && pBus->readPos && i < len; i++)
+	{
+		n = pBus->readPos + i * 9;
+		for (bit = 0, value = 0; bit < 8; bit++, n++)
+			value = (uint8_t)(value << 1) | ((pBus->rx[n >> 3] >> (n & 7)) & 1);
+		pData[i] = value;
+	}
+	return VL53L1_ERROR_NONE;
+}
+
+static VL53L1_Error waitDone(wave_bus *pBus)
+{
+	uint32_t start = HAL_GetTick();
+
+	while (pBus->busy)
+	{
+		if (HAL_GetTick() - start > WAVE_TIMEOUT_MS)
+		{
+			stopEngine(pBus);
+			return VL53L1_ERROR_TIME_OUT;
+		}
+		__WFI();
+	}
+	return VL53L1_ERROR_NONE;
+}
+
+//blocking, same shape as the platform VL53L1_ReadMulti()/VL53L1_WriteMulti()
+VL53L1_Error VL53WaveReadMulti(wave_bus *pBus, uint8_t address, uint16_t index, uint8_t *pData, uint32_t count)
+{
+	VL53L1_Error Status;
+
+	Status = VL53WaveStartRead(pBus, address, index, (uint16_t)count);
+	if (Status == VL53L1_ERROR_NONE)
+		Status = waitDone(pBus);
+	if (Status == VL53L1_ERROR_NONE)
+		Status = VL53WaveResult(pBus, pData, (uint16_t)count);
+	return Status;
+}
+
+VL53L1_Error VL53WaveWriteMulti(wave_bus *pBus, uint8_t address, uint16_t index, uint8_t *pData, uint32_t count)
+{
+	VL53L1_Error Status;
+
+	Status = VL53WaveStartWrite(pBus, address, index, pData, (uint16_t)count);
+	if (Status == VL53L1_ERROR_NONE)
+		Status = waitDone(pBus);
+	if (Status == VL53L1_ERROR_NONE)
+		Status = VL53WaveResult(pBus, NULL, 0);
+	return Status;
+}
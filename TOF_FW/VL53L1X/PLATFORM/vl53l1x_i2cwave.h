@@ -0,0 +1,74 @@
+/*
+ * vl53l1x_i2cwave.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: dkupe
+ */
+
+#ifndef VL53L1X_I2CWAVE_H_
+#define VL53L1X_I2CWAVE_H_
+
+#include "vl53l1x_api.h"
+#include "main.h"
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+//software I2C without the CPU in the bit loop, for boards where I2C1 is not usable.
+//a transfer is compiled into a symbol program (bit, START, STOP), a timer paces two DMA
+//channels: the update request writes one BSRR word per tick, the CC3 request half a
+//tick later copies IDR into the sample buffer. both buffers are circular and two chunks
+//long, the DMA half/complete interrupts encode the next chunk and decode the sampled
+//one. 4 ticks per bit, so a 1.6MHz tick gives 400kHz SCL.
+//TIM3: update -> DMA1 channel 3 (BSRR), CC3 -> DMA1 channel 2 (IDR), prescaler 0,
+//period 44, CC3 pulse 22, both DMA channels circular, word out and halfword in.
+//no clock stretching, the VL53L1X does not stretch at 400kHz.
+//the ranging driver only uses the engine once the platform layer's VL53L1_ReadMulti and
+//VL53L1_WriteMulti call VL53WaveReadMulti/VL53WaveWriteMulti, until then it is for
+//direct transfers only and I2C1 stays in charge of the bus. TIM3 and the two DMA
+//channels are left out of the CubeMX setup until then.
+
+#define WAVE_TICKS_PER_SYM   4
+#define WAVE_CHUNK_SYMS      16
+#define WAVE_CHUNK_TICKS     (WAVE_CHUNK_SYMS * WAVE_TICKS_PER_SYM)
+#ifndef WAVE_BYTES_MAX
+#define WAVE_BYTES_MAX       64	//payload of one transfer
+#endif
+//START, 3 header bytes, repeated START, address, payload, STOP
+#define WAVE_SYMS_MAX        (3 + (4 + WAVE_BYTES_MAX) * 9)
+
+typedef struct
+{
+	TIM_HandleTypeDef *htim;
+	DMA_HandleTypeDef *hdmaOut;    //memory -> BSRR, word, circular
+	DMA_HandleTypeDef *hdmaIn;     //IDR -> memory, half word, circular
+	GPIO_TypeDef *port;
+	uint16_t sclPin;
+	uint16_t sdaPin;
+	//program
+	uint8_t  sym[(WAVE_SYMS_MAX + 3) / 4];	//2 bits per symbol
+	uint8_t  ackCheck[(WAVE_SYMS_MAX + 7) / 8];
+	uint8_t  rx[(WAVE_SYMS_MAX + 7) / 8];	//SDA sampled in each symbol
+	uint16_t symCount;
+	uint16_t readPos;              //first symbol of the read payload
+	uint16_t encoded;              //symbols handed to the out buffer
+	uint16_t decoded;              //symbols taken from the sample buffer
+	volatile uint8_t busy;
+	uint32_t out[2 * WAVE_CHUNK_TICKS];
+	uint16_t in[2 * WAVE_CHUNK_TICKS];
+}wave_bus;
+
+void VL53WaveInit(wave_bus *pBus, TIM_HandleTypeDef *htim, DMA_HandleTypeDef *hdmaOut,
+		DMA_HandleTypeDef *hdmaIn, GPIO_TypeDef *port, uint16_t sclPin, uint16_t sdaPin);
+VL53L1_Error VL53WaveStartRead(wave_bus *pBus, uint8_t address, uint16_t index, uint16_t len);
+VL53L1_Error VL53WaveStartWrite(wave_bus *pBus, uint8_t address, uint16_t index, const uint8_t *pData, uint16_t len);
+VL53L1_Error VL53WaveResult(wave_bus *pBus, uint8_t *pData, uint16_t len);
+VL53L1_Error VL53WaveReadMulti(wave_bus *pBus, uint8_t address, uint16_t index, uint8_t *pData, uint32_t count);
+VL53L1_Error VL53WaveWriteMulti(wave_bus *pBus, uint8_t address, uint16_t index, uint8_t *pData, uint32_t count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VL53L1X_I2CWAVE_H_ */
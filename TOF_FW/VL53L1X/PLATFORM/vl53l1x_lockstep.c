@@ -0,0 +1,189 @@
+/*
+ * vl53l1x_lockstep.c
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: dkupe
+ */
+
+#include "vl53l1x_lockstep.h"
+#include <string.h>
+
+#define SDA_RELEASE(pBus)   LOCKSTEP_BSRR((pBus)->port, (pBus)->sdaMask)
+#define SDA_LOW(pBus)       LOCKSTEP_BSRR((pBus)->port, (uint32_t)(pBus)->sdaMask << 16)
+#define SCL_LOW(pBus)       LOCKSTEP_BSRR((pBus)->port, (uint32_t)(pBus)->sclPin << 16)
+
+static void delay(const lockstep_bus *pBus)
+{
+	volatile uint32_t n = pBus->halfPeriod;
+
+	while (n--)
+		;
+}
+
+//releases SCL and waits for a stretching slave
+static void sclHigh(const lockstep_bus *pBus)
+{
+	uint32_t n = LOCKSTEP_STRETCH_MAX;
+
+	LOCKSTEP_BSRR(pBus->port, pBus->sclPin);
+	while (!(LOCKSTEP_IDR(pBus->port) & pBus->sclPin) && --n)
+		;
+}
+
+static void start(const lockstep_bus *pBus)
+{
+	SDA_RELEASE(pBus);
+	sclHigh(pBus);
+	delay(pBus);
+	SDA_LOW(pBus);
+	delay(pBus);
+	SCL_LOW(pBus);
+}
+
+static void stop(const lockstep_bus *pBus)
+{
+	SDA_LOW(pBus);
+	delay(pBus);
+	sclHigh(pBus);
+	delay(pBus);
+	SDA_RELEASE(pBus);
+	delay(pBus);
+}
+
+//same byte on every lane, returns the SDA pins that NACKed
+static uint16_t writeByte(const lockstep_bus *pBus, uint8_t value)
+{
+	uint16_t nack;
+	uint8_t i;
+
+	for (i = 0; i < 8; i++, value <<= 1)
+	{
+		if (value & 0x80)
+			SDA_RELEASE(pBus);
+		else
+			SDA_LOW(pBus);
+		delay(pBus);
+		sclHigh(pBus);
+		delay(pBus);
+		SCL_LOW(pBus);
+	}
+	SDA_RELEASE(pBus);
+	delay(pBus);
+	sclHigh(pBus);
+	delay(pBus);
+	nack = LOCKSTEP_IDR(pBus->port) & pBus->sdaMask;
+	SCL_LOW(pBus);
+	return nack;
+}
+
+//one byte per lane into pData[lane * stride]
+static void readByte(const lockstep_bus *pBus, uint8_t *pData, uint16_t stride, uint8_t ack)
+{
+	uint16_t sample[8];
+	uint8_t i, lane;
+
+	SDA_RELEASE(pBus);
+	for (i = 0; i < 8; i++)
+	{
+		delay(pBus);
+		sclHigh(pBus);
+		delay(pBus);
+		sample[i] = (uint16_t)LOCKSTEP_IDR(pBus->port);
+		SCL_LOW(pBus);
+	}
+	if (ack)
+		SDA_LOW(pBus);
+	delay(pBus);
+	sclHigh(pBus);
+	delay(pBus);
+	SCL_LOW(pBus);
+	SDA_RELEASE(pBus);
+
+	//split while SCL is low, the slaves wait for the next clock
+	for (lane = 0; lane < pBus->lanes; lane++)
+	{
+		uint8_t shift = pBus->laneShift[lane];
+		uint8_t value = 0;
+
+		for (i = 0; i < 8; i++)
+			value = (uint8_t)(value << 1) | ((sample[i] >> shift) & 1);
+		pData[lane * stride] = value;
+	}
+}
+
+//returns the lane mask for a NACK mask of SDA pins
+static uint16_t laneMask(const lockstep_bus *pBus, uint16_t pins)
+{
+	uint16_t mask = 0;
+	uint8_t lane;
+
+	for (lane = 0; lane < pBus->lanes; lane++)
+		if (pins & (1u << pBus->laneShift[lane]))
+			mask |= 1u << lane;
+	return mask;
+}
+
+//returns the number of lanes, 0 if the pins do not fit
+uint8_t VL53LockstepInit(lockstep_bus *pBus, GPIO_TypeDef *port, uint16_t sclPin, uint16_t sdaMask, uint32_t speedKhz)
+{
+	GPIO_InitTypeDef GPIO_InitStruct = {0};
+	uint8_t bit;
+
+	memset(pBus, 0, sizeof(*pBus));
+	if (sdaMask & sclPin)
+		return 0;
+	for (bit = 0; bit < 16; bit++)
+	{
+		if (!(sdaMask & (1u << bit)))
+			continue;
+		if (pBus->lanes == LOCKSTEP_LANES_MAX)
+			return 0;
+		pBus->laneShift[pBus->lanes++] = bit;
+	}
+	pBus->port = port;
+	pBus->sclPin = sclPin;
+	pBus->sdaMask = sdaMask;
+	//~4 cycles per loop turn, the GPIO writes eat a bit more
+	pBus->halfPeriod = SystemCoreClock / (speedKhz * 1000 * 2 * 4);
+
+	LOCKSTEP_BSRR(port, sclPin | sdaMask);
+	GPIO_InitStruct.Pin = sclPin | sdaMask;
+	GPIO_InitStruct.Mode = GPIO_MODE_OUTPUT_OD;
+	GPIO_InitStruct.Pull = GPIO_NOPULL;
+	GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_HIGH;
+	HAL_GPIO_Init(port, &GPIO_InitStruct);
+	return pBus->lanes;
+}
+
+//same data to every lane (e.g. interrupt clear on all sensors), returns the lanes that NACKed
+uint16_t VL53LockstepWrite(lockstep_bus *pBus, uint8_t address, uint16_t index, const uint8_t *pData, uint16_t len)
+{
+	uint16_t nack;
+
+	start(pBus);
+	nack = writeByte(pBus, address & 0xFE);
+	nack |= writeByte(pBus, (uint8_t)(index >> 8));
+	nack |= writeByte(pBus, (uint8_t)index);
+	while (len--)
+		nack |= writeByte(pBus, *pData++);
+	stop(pBus);
+	return laneMask(pBus, nack);
+}
+
+//pData holds lanes * len bytes, lane after lane. returns the lanes that NACKed
+uint16_t VL53LockstepRead(lockstep_bus *pBus, uint8_t address, uint16_t index, uint8_t *pData, uint16_t len)
+{
+	uint16_t nack;
+	uint16_t i;
+
+	start(pBus);
+	nack = writeByte(pBus, address & 0xFE);
+	nack |= writeByte(pBus, (uint8_t)(index >> 8));
+	nack |= writeByte(pBus, (uint8_t)index);
+	start(pBus);
+	nack |= writeByte(pBus, address | 0x01);
+	for (i = 0; i < len; i++)
+		readByte(pBus, pData + i, len, i + 1 < len);
+	stop(pBus);
+	return laneMask(pBus, nack);
+}
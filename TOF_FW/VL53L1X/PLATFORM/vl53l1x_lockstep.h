@@ -0,0 +1,52 @@
+/*
+ * vl53l1x_lockstep.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: dkupe
+ */
+
+#ifndef VL53L1X_LOCKSTEP_H_
+#define VL53L1X_LOCKSTEP_H_
+
+#include "main.h"
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+//software I2C running several buses in lockstep: one SCL, one SDA per sensor, all on
+//the same GPIO port. every SDA level change is one BSRR write and every sample one IDR
+//read, so N sensors at the same address with the same config are read in the time of
+//one: address and index go out identical on all lanes, the bytes coming back are
+//split per lane after each byte. a lane that NACKs is reported and reads 0xFF.
+
+#ifndef LOCKSTEP_LANES_MAX
+#define LOCKSTEP_LANES_MAX   8
+#endif
+#define LOCKSTEP_STRETCH_MAX 1000	//SCL readback polls before clock stretching is ignored
+
+//port access, a host model can override these
+#ifndef LOCKSTEP_BSRR
+#define LOCKSTEP_BSRR(port, value)  ((port)->BSRR = (value))
+#define LOCKSTEP_IDR(port)          ((port)->IDR)
+#endif
+
+typedef struct
+{
+	GPIO_TypeDef *port;
+	uint16_t sclPin;
+	uint16_t sdaMask;          //one pin per lane
+	uint8_t  lanes;
+	uint8_t  laneShift[LOCKSTEP_LANES_MAX];	//SDA bit of each lane, lowest pin is lane 0
+	uint32_t halfPeriod;       //delay loop count for half an SCL period
+}lockstep_bus;
+
+uint8_t VL53LockstepInit(lockstep_bus *pBus, GPIO_TypeDef *port, uint16_t sclPin, uint16_t sdaMask, uint32_t speedKhz);
+uint16_t VL53LockstepWrite(lockstep_bus *pBus, uint8_t address, uint16_t index, const uint8_t *pData, uint16_t len);
+uint16_t VL53LockstepRead(lockstep_bus *pBus, uint8_t address, uint16_t index, uint8_t *pData, uint16_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VL53L1X_LOCKSTEP_H_ */
@@ -8,18 +8,13 @@
 #ifndef VL53L1X_PLATFORM_USER_DATA_H_
 #define VL53L1X_PLATFORM_USER_DATA_H_
 
-// #include "stm32xxx_hal.h"
+#include "stm32f1xx_hal.h"
 #include "vl53l1x_def.h"
 #ifdef __cplusplus
 extern "C"
 {
 #endif
 
-
-typedef struct {
-    uint32_t dummy;
-} I2C_HandleTypeDef;
-
 typedef struct {
 
 	VL53L1_DevData_t   Data;
@@ -28,7 +23,7 @@ typedef struct {
 	uint8_t   comms_type;
 	uint16_t  comms_speed_khz;
 	uint32_t  new_data_ready_poll_duration_ms;
-	I2C_HandleTypeDef *I2cHandle;
+	I2C_HandleTypeDef *I2cHandle;	//hi2c1, NULL for the bit-bang layer
 
 } VL53L1_Dev_t;
 
@@ -0,0 +1,182 @@
+/*
+ * vl53l1x_predict.c
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: dkupe
+ */
+
+#include "vl53l1x_predict.h"
+#include "timebase.h"
+#include <stdio.h>
+
+static int32_t clampDrift(int32_t drift)
+{
+	if (drift > PREDICT_DRIFT_MAX)
+		return PREDICT_DRIFT_MAX;
+	if (drift < -PREDICT_DRIFT_MAX)
+		return -PREDICT_DRIFT_MAX;
+	return drift;
+}
+
+//reads the configuration back, call again after changing budget, period or mode
+VL53L1_Error VL53PredictInit(VL53L1_Dev_t* pDev, predict_state *pState, uint16_t guardUs, uint16_t pollUs)
+{
+	VL53L1_LLDriverData_t *pLL = VL53L1DevStructGetLLDriverHandle(pDev);
+	VL53L1_Error Status = VL53L1_ERROR_NONE;
+	uint32_t budgetUs = 0, periodMs = 0;
+	uint16_t fastOsc = pLL->stat_nvm.osc_measured__fast_osc__frequency;
+
+	Status = VL53L1_GetMeasurementTimingBudgetMicroSeconds(pDev, &budgetUs);
+	if (Status == VL53L1_ERROR_NONE)
+		Status = VL53L1_GetInterMeasurementPeriodMilliSeconds(pDev, &periodMs);
+	if (Status != VL53L1_ERROR_NONE)
+		return Status;
+
+	if (!pState->learned || pState->fastOsc == 0)
+	{
+		memset(pState, 0, sizeof(*pState));
+		pState->fastOsc = fastOsc;
+	}
+	pState->guardUs = guardUs ? guardUs : PREDICT_GUARD_US_DEFAULT;
+	pState->pollUs = pollUs ? pollUs : PREDICT_POLL_US_DEFAULT;
+	//the device turns the budget into cycles with the current reading, the drift was
+	//learned against the old one
+	pState->nominalUs = budgetUs;
+	if (fastOsc != 0 && pState->fastOsc != 0)
+		pState->nominalUs = (uint32_t)(((uint64_t)budgetUs * fastOsc + (pState->fastOsc >> 1)) / pState->fastOsc);
+	//timed mode starts a range every period, a budget longer than the period stretches it,
+	//the period runs on the low power oscillator
+	if (pLL->measurement_mode == VL53L1_DEVICEMEASUREMENTMODE_TIMED && periodMs * 1000 > pState->nominalUs)
+		pState->nominalUs = periodMs * 1000;
+	return Status;
+}
+
+//call right after the range start, or after the interrupt clear that starts the next one
+void VL53PredictStart(predict_state *pState)
+{
+	pState->startUs = Timebase_Us();
+}
+
+uint32_t VL53PredictNextUs(const predict_state *pState)
+{
+	int32_t correction = (int32_t)(((int64_t)pState->nominalUs * pState->driftQ16) >> 16);
+
+	return pState->startUs + pState->nominalUs + correction;
+}
+
+static void learn(predict_state *pState, uint32_t actualUs, uint8_t late)
+{
+	int32_t err;
+
+	if (pState->nominalUs == 0)
+		return;
+	if (late)
+	{
+		//finished somewhere before the first poll, come in one guard earlier next time
+		err = -(int32_t)(((uint32_t)pState->guardUs << 16) / pState->nominalUs);
+		pState->driftQ16 = clampDrift(pState->driftQ16 + err);
+		return;
+	}
+	err = (int32_t)((((int64_t)actualUs - pState->nominalUs) << 16) / pState->nominalUs);
+	if (!pState->learned)
+		pState->driftQ16 = clampDrift(err);
+	else
+		pState->driftQ16 = clampDrift(pState->driftQ16 + ((err - pState->driftQ16) >> PREDICT_LEARN_SHIFT));
+	pState->learned = 1;
+}
+
+//the frame is done, the next prediction starts from its end (back-to-back and timed
+//ranging restart on their own, single shot has to call VL53PredictStart() again)
+static void finish(predict_state *pState, uint32_t endUs, uint8_t late)
+{
+	pState->lastPolls = pState->curPolls;
+	pState->curPolls = 0;
+	pState->frames++;
+	if (late)
+		pState->late++;
+	learn(pState, endUs - pState->startUs, late);
+	pState->startUs = endUs;
+}
+
+//no I2C access, tells a task released by its poll period whether the frame can be close
+uint8_t VL53PredictDue(const predict_state *pState)
+{
+	uint32_t wakeUs = VL53PredictNextUs(pState) - pState->guardUs;
+
+	return (int32_t)(Timebase_Us() - wakeUs) >= 0;
+}
+
+//one data ready read, for callers that must not block. the first read of a frame that is
+//already ready counts as late
+VL53L1_Error VL53PredictPoll(VL53L1_Dev_t* pDev, predict_state *pState, uint8_t *pReady)
+{
+	VL53L1_Error Status;
+
+	*pReady = 0;
+	Status = VL53L1_GetMeasurementDataReady(pDev, pReady);
+	if (pState->curPolls < 0xFF)
+		pState->curPolls++;
+	pState->polls++;
+	//the ready read took a whole transfer, the frame ended somewhere inside the last step
+	if (Status == VL53L1_ERROR_NONE && *pReady)
+		finish(pState, Timebase_Us(), pState->curPolls == 1);
+	return Status;
+}
+
+//frame end known from the GPIO1 edge, learns from the exact time
+void VL53PredictReady(predict_state *pState, uint32_t readyUs)
+{
+	finish(pState, readyUs, 0);
+}
+
+static void waitUntil(uint32_t targetUs)
+{
+	//SysTick wakes every ms, spin the rest
+	while ((int32_t)(targetUs - Timebase_Us()) > 1000)
+		__WFI();
+	while ((int32_t)(targetUs - Timebase_Us()) > 0)
+		;
+}
+
+//blocking form of VL53PredictDue() and VL53PredictPoll(), returns with the frame ready
+VL53L1_Error VL53PredictWait(VL53L1_Dev_t* pDev, predict_state *pState, uint32_t timeoutMs)
+{
+	VL53L1_Error Status = VL53L1_ERROR_NONE;
+	uint32_t wakeUs = VL53PredictNextUs(pState) - pState->guardUs;
+	uint32_t pollStartUs, nowUs;
+	uint32_t limitUs = timeoutMs * 1000;
+	uint8_t ready = 0;
+
+	if ((int32_t)(wakeUs - pState->startUs) > 0)
+		waitUntil(wakeUs);
+	pollStartUs = Timebase_Us();
+	while (1)
+	{
+		Status = VL53PredictPoll(pDev, pState, &ready);
+		nowUs = Timebase_Us();
+		if (Status != VL53L1_ERROR_NONE || ready)
+			break;
+		if (nowUs - pollStartUs > limitUs)
+		{
+			Status = VL53L1_ERROR_TIME_OUT;
+			break;
+		}
+		waitUntil(nowUs + pState->pollUs);
+	}
+	if (Status != VL53L1_ERROR_NONE)
+	{
+		pState->lastPolls = pState->curPolls;
+		pState->curPolls = 0;
+	}
+	return Status;
+}
+
+//PRD,frames,polls,late,nominal us,drift ppm
+int VL53PredictFormat(char *buf, size_t len, const predict_state *pState)
+{
+	long ppm = (long)(((int64_t)pState->driftQ16 * 1000000) >> 16);
+
+	return snprintf(buf, len, "PRD,%lu,%lu,%lu,%lu,%ld\r\n", (unsigned long)pState->frames,
+			(unsigned long)pState->polls, (unsigned long)pState->late,
+			(unsigned long)pState->nominalUs, ppm);
+}
@@ -0,0 +1,66 @@
+/*
+ * vl53l1x_predict.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: dkupe
+ */
+
+#ifndef VL53L1X_PREDICT_H_
+#define VL53L1X_PREDICT_H_
+
+#include "vl53l1x_api.h"
+#include "main.h"
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+//data ready wait without the polling from the start of the range that
+//VL53L1_WaitValueMaskEx() does. the frame period follows from the timing budget and, in
+//timed mode, the inter measurement period; the device counts both on its own oscillator,
+//so the period seen by the MCU is off by a per device drift that is learned from the
+//frames (EWMA, Q16 ratio). VL53PredictWait() sleeps until guardUs before the predicted
+//end and only then polls, every pollUs. a frame that is already ready on the first poll
+//says nothing about when it finished, so it only pulls the prediction in by a step.
+//the budget is counted in fast oscillator cycles worked out from the
+//osc_measured__fast_osc__frequency reading, so a reading other than the one the drift was
+//learned with scales nominalUs by the ratio of the two and the drift is kept.
+//a scheduler task that must not block checks VL53PredictDue() on every release and
+//calls VL53PredictPoll() once it is, a frame seen through the GPIO1 edge goes to
+//VL53PredictReady() instead.
+
+#define PREDICT_GUARD_US_DEFAULT   500
+#define PREDICT_POLL_US_DEFAULT    100
+#define PREDICT_DRIFT_MAX          (1 << 14)	//+-25%
+#define PREDICT_LEARN_SHIFT        3			//EWMA weight 1/8
+
+typedef struct
+{
+	uint32_t nominalUs;            //frame period from the configuration
+	int32_t  driftQ16;             //actual / nominal - 1
+	uint32_t startUs;              //range started, or the previous frame ended
+	uint16_t guardUs;
+	uint16_t pollUs;
+	uint16_t fastOsc;              //osc_measured__fast_osc__frequency the drift was learned with
+	uint8_t  learned;
+	uint8_t  curPolls;             //data ready reads for the frame in progress
+	uint8_t  lastPolls;            //data ready reads for the last frame
+	uint32_t frames;
+	uint32_t polls;
+	uint32_t late;                 //frames already ready on the first poll
+}predict_state;
+
+VL53L1_Error VL53PredictInit(VL53L1_Dev_t* pDev, predict_state *pState, uint16_t guardUs, uint16_t pollUs);
+void VL53PredictStart(predict_state *pState);
+uint32_t VL53PredictNextUs(const predict_state *pState);
+uint8_t VL53PredictDue(const predict_state *pState);
+VL53L1_Error VL53PredictPoll(VL53L1_Dev_t* pDev, predict_state *pState, uint8_t *pReady);
+void VL53PredictReady(predict_state *pState, uint32_t readyUs);
+VL53L1_Error VL53PredictWait(VL53L1_Dev_t* pDev, predict_state *pState, uint32_t timeoutMs);
+int VL53PredictFormat(char *buf, size_t len, const predict_state *pState);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VL53L1X_PREDICT_H_ */
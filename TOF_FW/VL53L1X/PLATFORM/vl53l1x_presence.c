@@ -0,0 +1,70 @@
+/*
+ * vl53l1x_presence.c
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: dkupe
+ */
+
+#include "vl53l1x_presence.h"
+
+static VL53L1_Error setWindow(VL53L1_Dev_t* pDev, const presence_config *pConfig, uint8_t present)
+{
+	VL53L1_DetectionConfig_t detection;
+
+	memset(&detection, 0, sizeof(detection));
+	detection.DetectionMode = VL53L1_DETECTION_DISTANCE_ONLY;
+	detection.IntrNoTarget = present;	//target walking out of range counts as leaving
+	detection.Distance.CrossMode = present ? VL53L1_THRESHOLD_OUT_OF_WINDOW : VL53L1_THRESHOLD_IN_WINDOW;
+	detection.Distance.Low = pConfig->lowMm;
+	detection.Distance.High = pConfig->highMm;
+	return VL53L1_SetThresholdConfig(pDev, &detection);
+}
+
+VL53L1_Error VL53PresenceStart(VL53L1_Dev_t* pDev, presence_state *pState, const presence_config *pConfig)
+{
+	VL53L1_Error Status = VL53L1_ERROR_NONE;
+
+	memset(pState, 0, sizeof(*pState));
+	pState->pConfig = pConfig;
+
+	Status = VL53L1_StopMeasurement(pDev);
+	if (Status == VL53L1_ERROR_NONE)
+		Status = VL53L1_SetPresetMode(pDev, VL53L1_PRESETMODE_LOWPOWER_AUTONOMOUS);
+	if (Status == VL53L1_ERROR_NONE)
+		Status = VL53L1_SetDistanceMode(pDev, pConfig->distanceMode);
+	if (Status == VL53L1_ERROR_NONE)
+		Status = VL53L1_SetMeasurementTimingBudgetMicroSeconds(pDev, pConfig->timingBudgetUs);
+	if (Status == VL53L1_ERROR_NONE)
+		Status = VL53L1_SetInterMeasurementPeriodMilliSeconds(pDev, pConfig->interMeasurementMs);
+	if (Status == VL53L1_ERROR_NONE)
+		Status = setWindow(pDev, pConfig, 0);
+	if (Status == VL53L1_ERROR_NONE)
+		Status = VL53L1_StartMeasurement(pDev);
+	return Status;
+}
+
+VL53L1_Error VL53PresenceStop(VL53L1_Dev_t* pDev)
+{
+	return VL53L1_StopMeasurement(pDev);
+}
+
+//call after GPIO1 fired. reads the frame that triggered, flips the window and restarts
+VL53L1_Error VL53PresenceService(VL53L1_Dev_t* pDev, presence_state *pState)
+{
+	VL53L1_Error Status = VL53L1_ERROR_NONE;
+
+	Status = VL53L1_GetRangingMeasurementData(pDev, &pState->last);
+	if (Status != VL53L1_ERROR_NONE)
+		return Status;
+
+	pState->present = !pState->present;
+	pState->events++;
+
+	//the threshold registers are only sampled at range start
+	Status = VL53L1_StopMeasurement(pDev);
+	if (Status == VL53L1_ERROR_NONE)
+		Status = setWindow(pDev, pState->pConfig, pState->present);
+	if (Status == VL53L1_ERROR_NONE)
+		Status = VL53L1_StartMeasurement(pDev);
+	return Status;
+}
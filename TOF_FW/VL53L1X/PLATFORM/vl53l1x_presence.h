@@ -0,0 +1,47 @@
+/*
+ * vl53l1x_presence.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: dkupe
+ */
+
+#ifndef VL53L1X_PRESENCE_H_
+#define VL53L1X_PRESENCE_H_
+
+#include "vl53l1x_api.h"
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+//presence detection on top of VL53L1_PRESETMODE_LOWPOWER_AUTONOMOUS.
+//the sensor only raises GPIO1 when the distance crosses the window, so the MCU can
+//stay in STOP between events. while absent the sensor waits for IN_WINDOW, while
+//present it waits for OUT_OF_WINDOW, so both arrival and departure wake the MCU.
+
+typedef struct
+{
+	uint16_t lowMm;                //window the target has to be in to count as present
+	uint16_t highMm;
+	uint32_t timingBudgetUs;
+	uint32_t interMeasurementMs;   //sensor duty cycle, dominates the sensor current
+	VL53L1_DistanceModes distanceMode;
+}presence_config;
+
+typedef struct
+{
+	const presence_config *pConfig;
+	uint8_t  present;
+	uint32_t events;
+	VL53L1_RangingMeasurementData_t last;
+}presence_state;
+
+VL53L1_Error VL53PresenceStart(VL53L1_Dev_t* pDev, presence_state *pState, const presence_config *pConfig);
+VL53L1_Error VL53PresenceStop(VL53L1_Dev_t* pDev);
+VL53L1_Error VL53PresenceService(VL53L1_Dev_t* pDev, presence_state *pState);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VL53L1X_PRESENCE_H_ */
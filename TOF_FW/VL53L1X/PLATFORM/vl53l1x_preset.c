@@ -0,0 +1,77 @@
+/*
+ * vl53l1x_preset.c
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: dkupe
+ */
+
+#include "vl53l1x_preset.h"
+
+#define PRESET(m, dm, signal, sigma, budget) \
+	{ .mode = (m), .distanceMode = (dm), .sigmaThresh = PRESET_SIGMA_REG(sigma), \
+	  .minCountRate = PRESET_RATE_REG(signal), .timingBudget = (budget) }
+
+//same limits as the mode_data table, manual 6.2
+static const preset_def presetTable[] =
+{
+#if VL53_PRESET_DEFAULT
+	PRESET(DEFAULT_MODE,  VL53L1_DISTANCEMODE_LONG,   FIX1616_CONST(0, 250), FIX1616_CONST(18, 0), 33000),
+#endif
+#if VL53_PRESET_HIGH_ACCURACY
+	PRESET(HIGH_ACCURACY, VL53L1_DISTANCEMODE_MEDIUM, FIX1616_CONST(0, 250), FIX1616_CONST(18, 0), 200000),
+#endif
+#if VL53_PRESET_LONG_RANGE
+	PRESET(LONG_RANGE,    VL53L1_DISTANCEMODE_LONG,   FIX1616_CONST(0, 100), FIX1616_CONST(60, 0), 33000),
+#endif
+#if VL53_PRESET_HIGH_SPEED
+	PRESET(HIGH_SPEED,    VL53L1_DISTANCEMODE_SHORT,  FIX1616_CONST(0, 250), FIX1616_CONST(32, 0), 20000),
+#endif
+};
+
+#define PRESET_COUNT  (sizeof(presetTable) / sizeof(presetTable[0]))
+
+const preset_def *VL53PresetGet(uint8_t mode)
+{
+	uint8_t i;
+
+	for (i = 0; i < PRESET_COUNT; i++)
+		if (presetTable[i].mode == mode)
+			return &presetTable[i];
+	return NULL;
+}
+
+//ranging must be stopped, the limits reach the device with the next
+//VL53L1_StartMeasurement(), which writes the timing block from tim_cfg
+VL53L1_Error VL53PresetApply(VL53L1_Dev_t* pDev, uint8_t mode)
+{
+	VL53L1_Error Status = VL53L1_ERROR_NONE;
+	const preset_def *pPreset = VL53PresetGet(mode);
+	VL53L1_timing_config_t *pCfg = &VL53L1DevStructGetLLDriverHandle(pDev)->tim_cfg;
+	VL53L1_DistanceModes distanceMode;
+	uint32_t budget;
+
+	if (pPreset == NULL)
+		return VL53L1_ERROR_MODE_NOT_SUPPORTED;
+
+	Status = VL53L1_GetDistanceMode(pDev, &distanceMode);
+	if (Status == VL53L1_ERROR_NONE && distanceMode != pPreset->distanceMode)
+		Status = VL53L1_SetDistanceMode(pDev, pPreset->distanceMode);
+	if (Status == VL53L1_ERROR_NONE)
+		Status = VL53L1_GetMeasurementTimingBudgetMicroSeconds(pDev, &budget);
+	if (Status == VL53L1_ERROR_NONE && budget != pPreset->timingBudget)
+		Status = VL53L1_SetMeasurementTimingBudgetMicroSeconds(pDev, pPreset->timingBudget);
+
+	//what the two SetLimitCheckValue()/Enable() pairs would leave behind
+	if (Status == VL53L1_ERROR_NONE)
+	{
+		pCfg->range_config__sigma_thresh = pPreset->sigmaThresh;
+		pCfg->range_config__min_count_rate_rtn_limit_mcps = pPreset->minCountRate;
+		pDev->Data.CurrentParameters.LimitChecksEnable[VL53L1_CHECKENABLE_SIGMA_FINAL_RANGE] = 1;
+		pDev->Data.CurrentParameters.LimitChecksEnable[VL53L1_CHECKENABLE_SIGNAL_RATE_FINAL_RANGE] = 1;
+		pDev->Data.CurrentParameters.LimitChecksValue[VL53L1_CHECKENABLE_SIGMA_FINAL_RANGE] =
+				fixRescale(pPreset->sigmaThresh, FIX142_FRAC_BITS, FIX1616_FRAC_BITS);
+		pDev->Data.CurrentParameters.LimitChecksValue[VL53L1_CHECKENABLE_SIGNAL_RATE_FINAL_RANGE] =
+				fix97To1616(pPreset->minCountRate);
+	}
+	return Status;
+}
@@ -0,0 +1,57 @@
+/*
+ * vl53l1x_preset.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: dkupe
+ */
+
+#ifndef VL53L1X_PRESET_H_
+#define VL53L1X_PRESET_H_
+
+#include "vl53l1x.h"
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+//the four wrapper modes as const tables. the limits are stored already encoded in the
+//device register formats, so applying a preset is a copy into the driver's timing
+//config (tim_cfg) with no I2C traffic; VL53L1_StartMeasurement() writes the whole
+//timing block from that cache. distance mode and timing budget still go through the
+//API, but only when they change.
+//presets set to 0 below are compiled out, applying them returns MODE_NOT_SUPPORTED.
+
+#ifndef VL53_PRESET_DEFAULT
+#define VL53_PRESET_DEFAULT        1
+#endif
+#ifndef VL53_PRESET_HIGH_ACCURACY
+#define VL53_PRESET_HIGH_ACCURACY  1
+#endif
+#ifndef VL53_PRESET_LONG_RANGE
+#define VL53_PRESET_LONG_RANGE     1
+#endif
+#ifndef VL53_PRESET_HIGH_SPEED
+#define VL53_PRESET_HIGH_SPEED     1
+#endif
+
+//16.16 limits -> range_config__sigma_thresh (14.2 mm) and min_count_rate (9.7 Mcps)
+#define PRESET_SIGMA_REG(fix1616)  ((uint16_t)FIX_RESCALE_CONST(fix1616, FIX1616_FRAC_BITS, FIX142_FRAC_BITS))
+#define PRESET_RATE_REG(fix1616)   ((FixPoint97_t)FIX_RESCALE_CONST(fix1616, FIX1616_FRAC_BITS, FIX97_FRAC_BITS))
+
+typedef struct
+{
+	uint8_t  mode;                 //DEFAULT_MODE..HIGH_SPEED
+	uint8_t  distanceMode;         //VL53L1_DISTANCEMODE_xxx
+	uint16_t sigmaThresh;          //register value, PRESET_SIGMA_REG()
+	uint16_t minCountRate;         //register value, PRESET_RATE_REG()
+	uint32_t timingBudget;         //us
+}preset_def;
+
+VL53L1_Error VL53PresetApply(VL53L1_Dev_t* pDev, uint8_t mode);
+const preset_def *VL53PresetGet(uint8_t mode);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VL53L1X_PRESET_H_ */
@@ -0,0 +1,138 @@
+/*
+ * vl53l1x_recovery.c
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: dkupe
+ */
+
+#include "vl53l1x_recovery.h"
+#include "vl53l1x_busrecover.h"
+#include <stdio.h>
+
+#define RECOVERY_XSHUT_MS   2	//tBOOT is 1.2ms
+
+static VL53L1_Error softReset(VL53L1_Dev_t* pDev, const recovery_config *pConfig)
+{
+	VL53L1_Error Status;
+
+	Status = VL53L1_software_reset(pDev);
+	if (Status == VL53L1_ERROR_NONE && pConfig->reinit)
+		Status = pConfig->reinit(pDev);
+	return Status;
+}
+
+static VL53L1_Error powerCycle(VL53L1_Dev_t* pDev, const recovery_config *pConfig)
+{
+	VL53L1_Error Status = VL53L1_ERROR_NONE;
+
+	HAL_GPIO_WritePin(pConfig->xshutPort, pConfig->xshutPin, GPIO_PIN_RESET);
+	HAL_Delay(RECOVERY_XSHUT_MS);
+	HAL_GPIO_WritePin(pConfig->xshutPort, pConfig->xshutPin, GPIO_PIN_SET);
+	HAL_Delay(RECOVERY_XSHUT_MS);
+	if (pConfig->reinit)
+		Status = pConfig->reinit(pDev);
+	return Status;
+}
+
+void VL53RecoveryInit(recovery_state *pState, const recovery_config *pConfig)
+{
+	memset(pState, 0, sizeof(*pState));
+	pState->pConfig = pConfig;
+}
+
+uint8_t VL53RecoveryClassify(VL53L1_Error Status)
+{
+	switch (Status)
+	{
+	case VL53L1_ERROR_CONTROL_INTERFACE:
+	case VL53L1_ERROR_COMMS_BUFFER_TOO_SMALL:
+		return RECOVERY_CLASS_BUS;
+	case VL53L1_ERROR_TIME_OUT:
+		return RECOVERY_CLASS_TIMEOUT;
+	case VL53L1_ERROR_GPH_SYNC_CHECK_FAIL:
+	case VL53L1_ERROR_STREAM_COUNT_CHECK_FAIL:
+	case VL53L1_ERROR_GPH_ID_CHECK_FAIL:
+	case VL53L1_ERROR_ZONE_STREAM_COUNT_CHECK_FAIL:
+	case VL53L1_ERROR_ZONE_GPH_ID_CHECK_FAIL:
+		return RECOVERY_CLASS_SYNC;
+	case VL53L1_ERROR_CALIBRATION_WARNING:
+	case VL53L1_ERROR_MIN_CLIPPED:
+		return RECOVERY_CLASS_WARNING;
+	default:
+		return RECOVERY_CLASS_OTHER;
+	}
+}
+
+uint8_t VL53RecoveryHandle(VL53L1_Dev_t* pDev, recovery_state *pState, VL53L1_Error Status)
+{
+	const recovery_config *pConfig = pState->pConfig;
+	recovery_stats *pStats = &pState->stats;
+	uint8_t errClass = RECOVERY_CLASS_OTHER;
+
+	if (Status != VL53L1_ERROR_NONE)
+	{
+		errClass = VL53RecoveryClassify(Status);
+		pStats->count[errClass]++;
+		pStats->lastError = Status;
+		if (errClass == RECOVERY_CLASS_WARNING)
+			Status = VL53L1_ERROR_NONE;
+	}
+	if (Status == VL53L1_ERROR_NONE)
+	{
+		if (pState->failing)
+			pStats->recovered++;
+		pState->retries = 0;
+		pState->busCleared = 0;
+		pState->softResets = 0;
+		pState->failing = 0;
+		return RECOVERY_OK;
+	}
+	pState->failing = 1;
+
+	if (errClass == RECOVERY_CLASS_BUS && pState->retries < pConfig->maxRetries)
+	{
+		pState->retries++;
+		pStats->retries++;
+		return RECOVERY_RETRY;
+	}
+	pState->retries = 0;
+
+	//the cheap way out of a bus hang, the sensor keeps its state so no reset is needed
+	if (errClass == RECOVERY_CLASS_BUS && pConfig->busClear && !pState->busCleared)
+	{
+		pState->busCleared = 1;
+		pStats->busClears++;
+		if (VL53BusRecover(pDev) == VL53L1_ERROR_NONE && VL53BusResume(pDev) == VL53L1_ERROR_NONE)
+			return RECOVERY_RESET;
+	}
+
+	//a dead bus fails the reset write as well, that goes straight to the power cycle
+	if (pState->softResets < pConfig->maxSoftResets)
+	{
+		pState->softResets++;
+		pStats->softResets++;
+		if (softReset(pDev, pConfig) == VL53L1_ERROR_NONE)
+			return RECOVERY_RESET;
+	}
+	if (pConfig->xshutPort)
+	{
+		pState->softResets = 0;
+		pStats->powerCycles++;
+		if (powerCycle(pDev, pConfig) == VL53L1_ERROR_NONE)
+			return RECOVERY_RESET;
+	}
+	pStats->failed++;
+	return RECOVERY_FAILED;
+}
+
+//ERR,bus,timeout,sync,warning,other,retries,bus clears,soft resets,power cycles,recovered,failed,last
+int VL53RecoveryFormat(char *buf, size_t len, const recovery_stats *pStats)
+{
+	return snprintf(buf, len, "ERR,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%d\r\n",
+			(unsigned long)pStats->count[RECOVERY_CLASS_BUS], (unsigned long)pStats->count[RECOVERY_CLASS_TIMEOUT],
+			(unsigned long)pStats->count[RECOVERY_CLASS_SYNC], (unsigned long)pStats->count[RECOVERY_CLASS_WARNING],
+			(unsigned long)pStats->count[RECOVERY_CLASS_OTHER], (unsigned long)pStats->retries,
+			(unsigned long)pStats->busClears, (unsigned long)pStats->softResets,
+			(unsigned long)pStats->powerCycles,
+			(unsigned long)pStats->recovered, (unsigned long)pStats->failed, (int)pStats->lastError);
+}
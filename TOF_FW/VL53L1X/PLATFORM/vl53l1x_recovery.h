@@ -0,0 +1,83 @@
+/*
+ * vl53l1x_recovery.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: dkupe
+ */
+
+#ifndef VL53L1X_RECOVERY_H_
+#define VL53L1X_RECOVERY_H_
+
+#include "vl53l1x_api.h"
+#include "vl53l1x_api_core.h"
+#include "main.h"
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+//every VL53L1_Error the application gets goes through VL53RecoveryHandle(). it is
+//classified, counted, and answered with the smallest step that can clear it:
+//  bus (NACK, arbitration)  -> retry the operation, up to maxRetries in a row,
+//                              then clock out a stuck bus and resume from the cache
+//  timeout, stream/GPH sync -> VL53L1_software_reset + reinit
+//  still failing            -> XSHUT power cycle + reinit
+//any success resets the escalation. reinit has to bring the device back to ranging,
+//after a power cycle that includes moving it off the default address.
+
+//error class
+#define RECOVERY_CLASS_BUS       0
+#define RECOVERY_CLASS_TIMEOUT   1
+#define RECOVERY_CLASS_SYNC      2
+#define RECOVERY_CLASS_WARNING   3	//calibration warning, min clipped: counted only
+#define RECOVERY_CLASS_OTHER     4
+#define RECOVERY_CLASSES         5
+
+//VL53RecoveryHandle() result
+#define RECOVERY_OK              0	//no error or warning only
+#define RECOVERY_RETRY           1	//repeat the failed operation
+#define RECOVERY_RESET           2	//device reset and reinitialised, restart from scratch
+#define RECOVERY_FAILED          3	//device unreachable, try again later
+
+typedef struct
+{
+	uint8_t  maxRetries;
+	uint8_t  maxSoftResets;        //in a row before the power cycle
+	uint8_t  busClear;             //run VL53BusRecover() before resetting the device
+	GPIO_TypeDef *xshutPort;       //NULL = no power cycle
+	uint16_t xshutPin;
+	VL53L1_Error (*reinit)(VL53L1_Dev_t* pDev);
+}recovery_config;
+
+typedef struct
+{
+	uint32_t count[RECOVERY_CLASSES];
+	uint32_t retries;
+	uint32_t busClears;
+	uint32_t softResets;
+	uint32_t powerCycles;
+	uint32_t recovered;            //error sequences that ended in a success
+	uint32_t failed;
+	VL53L1_Error lastError;
+}recovery_stats;
+
+typedef struct
+{
+	const recovery_config *pConfig;
+	uint8_t  retries;              //current escalation
+	uint8_t  busCleared;
+	uint8_t  softResets;
+	uint8_t  failing;
+	recovery_stats stats;
+}recovery_state;
+
+void VL53RecoveryInit(recovery_state *pState, const recovery_config *pConfig);
+uint8_t VL53RecoveryClassify(VL53L1_Error Status);
+uint8_t VL53RecoveryHandle(VL53L1_Dev_t* pDev, recovery_state *pState, VL53L1_Error Status);
+int VL53RecoveryFormat(char *buf, size_t len, const recovery_stats *pStats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VL53L1X_RECOVERY_H_ */
@@ -0,0 +1,152 @@
+/*
+ * vl53l1x_roi.c
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: dkupe
+ */
+
+#include "vl53l1x_roi.h"
+#include "vl53l1x_fixpoint.h"
+
+//device SPAD numbering, same as the driver's row/col encoding:
+//lower half counts up the columns from the right, upper half from the left
+static uint8_t spadFromRowCol(uint8_t row, uint8_t col)
+{
+	if (row > 7)
+		return 128 + (col << 3) + (15 - row);
+	return ((15 - col) << 3) + row;
+}
+
+static void rowColFromSpad(uint8_t spad, uint8_t *pRow, uint8_t *pCol)
+{
+	if (spad > 127)
+	{
+		*pRow = 8 + ((255 - spad) & 0x07);
+		*pCol = (spad - 128) >> 3;
+	}
+	else
+	{
+		*pRow = spad & 0x07;
+		*pCol = (127 - spad) >> 3;
+	}
+}
+
+static uint8_t clampGrid(int16_t value)
+{
+	if (value < 0)
+		return 0;
+	if (value > ROI_GRID - 1)
+		return ROI_GRID - 1;
+	return (uint8_t)value;
+}
+
+void VL53RoiLutBuild(roi_lut *pLut, int8_t dx, int8_t dy)
+{
+	uint16_t i;
+
+	pLut->dx = dx;
+	pLut->dy = dy;
+	for (i = 0; i < ROI_GRID * ROI_GRID; i++)
+	{
+		uint8_t x = i & 0x0F, y = i >> 4;
+
+		pLut->encode[i] = spadFromRowCol(clampGrid(y + dy), clampGrid(x + dx));
+	}
+	for (i = 0; i < ROI_GRID * ROI_GRID; i++)
+	{
+		uint8_t row, col;
+		int16_t x, y;
+
+		rowColFromSpad((uint8_t)i, &row, &col);
+		x = (int16_t)col - dx;
+		y = (int16_t)row - dy;
+		if (x < 0 || x >= ROI_GRID || y < 0 || y >= ROI_GRID)
+		{
+			pLut->decode[i] = 0;
+			pLut->onGrid[i >> 3] &= ~(1 << (i & 7));
+		}
+		else
+		{
+			pLut->decode[i] = (uint8_t)((x << 4) | y);
+			pLut->onGrid[i >> 3] |= 1 << (i & 7);
+		}
+	}
+}
+
+//reads the optical centre stored at final test (no I2C access) and builds the LUT
+VL53L1_Error VL53RoiLutInit(VL53L1_Dev_t* pDev, roi_lut *pLut)
+{
+	VL53L1_Error Status = VL53L1_ERROR_NONE;
+	FixPoint1616_t centreX, centreY;
+
+	Status = VL53L1_GetOpticalCenter(pDev, &centreX, &centreY);
+	if (Status != VL53L1_ERROR_NONE)
+		return Status;
+	VL53RoiLutBuild(pLut, (int8_t)((int32_t)fix1616ToInt(centreX) - ROI_NOMINAL_CENTRE),
+			(int8_t)((int32_t)fix1616ToInt(centreY) - ROI_NOMINAL_CENTRE));
+	return Status;
+}
+
+//(x, y) is the logical centre in driver convention: a w wide ROI covers
+//x - w/2 .. x + (w-1)/2. the centre is pulled in so the shifted ROI stays on the array
+roi_code VL53RoiEncode(const roi_lut *pLut, uint8_t x, uint8_t y, uint8_t w, uint8_t h)
+{
+	roi_code code;
+	int16_t px, py;
+
+	if (w < 1)
+		w = 1;
+	if (w > ROI_GRID)
+		w = ROI_GRID;
+	if (h < 1)
+		h = 1;
+	if (h > ROI_GRID)
+		h = ROI_GRID;
+
+	px = (int16_t)x + pLut->dx;
+	py = (int16_t)y + pLut->dy;
+	if (px < w / 2)
+		px = w / 2;
+	if (px > ROI_GRID - 1 - (w - 1) / 2)
+		px = ROI_GRID - 1 - (w - 1) / 2;
+	if (py < h / 2)
+		py = h / 2;
+	if (py > ROI_GRID - 1 - (h - 1) / 2)
+		py = ROI_GRID - 1 - (h - 1) / 2;
+
+	//back to logical so the clamped centre goes through the table
+	code.centreSpad = pLut->encode[((py - pLut->dy) << 4 | (px - pLut->dx)) & 0xFF];
+	code.xySize = (uint8_t)(((h - 1) << 4) | (w - 1));
+	return code;
+}
+
+roi_code VL53RoiEncodeUser(const roi_lut *pLut, const VL53L1_UserRoi_t *pRoi)
+{
+	return VL53RoiEncode(pLut, (pRoi->TopLeftX + pRoi->BotRightX + 1) / 2,
+			(pRoi->TopLeftY + pRoi->BotRightY + 1) / 2,
+			pRoi->BotRightX - pRoi->TopLeftX + 1, pRoi->TopLeftY - pRoi->BotRightY + 1);
+}
+
+//returns 0 if the centre SPAD is outside the logical grid of this part
+uint8_t VL53RoiDecode(const roi_lut *pLut, roi_code code, uint8_t *pX, uint8_t *pY, uint8_t *pW, uint8_t *pH)
+{
+	uint8_t packed = pLut->decode[code.centreSpad];
+
+	*pW = (code.xySize & 0x0F) + 1;
+	*pH = (code.xySize >> 4) + 1;
+	if (!(pLut->onGrid[code.centreSpad >> 3] & (1 << (code.centreSpad & 7))))
+		return 0;
+	*pX = packed >> 4;
+	*pY = packed & 0x0F;
+	return 1;
+}
+
+//updates the driver's cached dynamic config, the next clear interrupt / start
+//writes it inside the grouped parameter hold like VL53L1_SetUserROI would
+void VL53RoiApply(VL53L1_Dev_t* pDev, roi_code code)
+{
+	VL53L1_LLDriverData_t *pdev = VL53L1DevStructGetLLDriverHandle(pDev);
+
+	pdev->dyn_cfg.roi_config__user_roi_centre_spad = code.centreSpad;
+	pdev->dyn_cfg.roi_config__user_roi_requested_global_xy_size = code.xySize;
+}
@@ -0,0 +1,53 @@
+/*
+ * vl53l1x_roi.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: dkupe
+ */
+
+#ifndef VL53L1X_ROI_H_
+#define VL53L1X_ROI_H_
+
+#include "vl53l1x_api.h"
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+//ROI geometry relative to the part's optical centre. logical coordinates are the
+//VL53L1_UserRoi_t ones (0-15, y up) of an ideal part whose optical centre is (8,8);
+//the LUT shifts them by the measured optical centre and maps them to the device's
+//SPAD numbering. build the LUT once, compile zones to roi_code once, after that a
+//zone switch is two cached register bytes.
+
+#define ROI_GRID           16
+#define ROI_NOMINAL_CENTRE 8
+
+typedef struct
+{
+	uint8_t centreSpad;        //ROI_CONFIG__USER_ROI_CENTRE_SPAD
+	uint8_t xySize;            //ROI_CONFIG__USER_ROI_REQUESTED_GLOBAL_XY_SIZE, (h-1)<<4 | (w-1)
+}roi_code;
+
+typedef struct
+{
+	int8_t  dx;                //optical centre - nominal centre, SPADs
+	int8_t  dy;
+	uint8_t encode[ROI_GRID * ROI_GRID];   //[y*16 + x] logical centre -> SPAD number
+	uint8_t decode[ROI_GRID * ROI_GRID];   //SPAD number -> x<<4 | y logical
+	uint8_t onGrid[ROI_GRID * ROI_GRID / 8];   //bit set = SPAD has a logical position
+}roi_lut;
+
+void VL53RoiLutBuild(roi_lut *pLut, int8_t dx, int8_t dy);
+VL53L1_Error VL53RoiLutInit(VL53L1_Dev_t* pDev, roi_lut *pLut);
+
+roi_code VL53RoiEncode(const roi_lut *pLut, uint8_t x, uint8_t y, uint8_t w, uint8_t h);
+roi_code VL53RoiEncodeUser(const roi_lut *pLut, const VL53L1_UserRoi_t *pRoi);
+uint8_t VL53RoiDecode(const roi_lut *pLut, roi_code code, uint8_t *pX, uint8_t *pY, uint8_t *pW, uint8_t *pH);
+void VL53RoiApply(VL53L1_Dev_t* pDev, roi_code code);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VL53L1X_ROI_H_ */
@@ -0,0 +1,157 @@
+/*
+ * vl53l1x_rules.c
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: dkupe
+ */
+
+#include "vl53l1x_rules.h"
+
+static uint8_t isIdle(const rules_engine *pEngine)
+{
+	uint8_t i;
+
+	for (i = 0; i < pEngine->count; i++)
+		if (pEngine->active[i] || pEngine->pending[i])
+			return 0;
+	return 1;
+}
+
+//first stage for the sensor. all rules idle means every WITHIN rule waits for an object
+//to enter its window (union of windows, IN_WINDOW) or every OUTSIDE rule waits for it
+//to leave (intersection, OUT_OF_WINDOW). anything else needs every frame.
+static void buildDetection(const rules_engine *pEngine, VL53L1_DetectionConfig_t *pDetection)
+{
+	const rule_def *pRules = pEngine->pRules;
+	uint16_t low = 0xFFFF, high = 0;
+	uint8_t kind = pRules[0].kind;
+	uint8_t i;
+
+	memset(pDetection, 0, sizeof(*pDetection));
+	pDetection->DetectionMode = VL53L1_DETECTION_NORMAL_RUN;
+	if (!isIdle(pEngine))
+		return;
+
+	if (kind == RULE_OUTSIDE)
+	{
+		low = 0;
+		high = 0xFFFF;
+	}
+	for (i = 0; i < pEngine->count; i++)
+	{
+		if (pRules[i].kind != kind)
+			return;
+		if (kind == RULE_WITHIN)
+		{
+			if (pRules[i].lowMm < low)
+				low = pRules[i].lowMm;
+			if (pRules[i].highMm > high)
+				high = pRules[i].highMm;
+		}
+		else
+		{
+			if (pRules[i].lowMm > low)
+				low = pRules[i].lowMm;
+			if (pRules[i].highMm < high)
+				high = pRules[i].highMm;
+		}
+	}
+	if (low >= high)
+		return;
+
+	pDetection->DetectionMode = VL53L1_DETECTION_DISTANCE_ONLY;
+	pDetection->IntrNoTarget = (kind == RULE_OUTSIDE);
+	pDetection->Distance.CrossMode = (kind == RULE_WITHIN) ? VL53L1_THRESHOLD_IN_WINDOW : VL53L1_THRESHOLD_OUT_OF_WINDOW;
+	pDetection->Distance.Low = low;
+	pDetection->Distance.High = high;
+}
+
+static VL53L1_Error program(VL53L1_Dev_t* pDev, rules_engine *pEngine)
+{
+	VL53L1_Error Status = VL53L1_ERROR_NONE;
+	VL53L1_DetectionConfig_t detection;
+
+	buildDetection(pEngine, &detection);
+	pEngine->hwWindow = (detection.DetectionMode != VL53L1_DETECTION_NORMAL_RUN);
+
+	//threshold registers are only taken at range start
+	Status = VL53L1_StopMeasurement(pDev);
+	if (Status == VL53L1_ERROR_NONE)
+		Status = VL53L1_SetThresholdConfig(pDev, &detection);
+	if (Status == VL53L1_ERROR_NONE)
+		Status = VL53L1_StartMeasurement(pDev);
+	return Status;
+}
+
+static uint8_t matches(const rule_def *pRule, uint8_t active, const VL53L1_RangingMeasurementData_t *pData)
+{
+	int32_t low = pRule->lowMm, high = pRule->highMm;
+	int32_t h = active ? pRule->hysteresisMm : 0;
+	uint8_t inside;
+
+	if (pRule->kind == RULE_OUTSIDE)
+		h = -h;
+	low -= h;
+	high += h;
+
+	inside = (pData->RangeStatus == VL53L1_RANGESTATUS_RANGE_VALID) &&
+			(pData->RangeMilliMeter >= low) && (pData->RangeMilliMeter <= high);
+	return (pRule->kind == RULE_WITHIN) ? inside : !inside;
+}
+
+//the sensor keeps ranging with the configuration the caller set up (preset, budget,
+//inter measurement period), only the detection config is owned by the engine
+VL53L1_Error VL53RulesStart(VL53L1_Dev_t* pDev, rules_engine *pEngine, const rule_def *pRules, uint8_t count)
+{
+	if (count == 0 || count > RULES_MAX)
+		return VL53L1_ERROR_INVALID_PARAMS;
+
+	memset(pEngine, 0, sizeof(*pEngine));
+	pEngine->pRules = pRules;
+	pEngine->count = count;
+	return program(pDev, pEngine);
+}
+
+//call after GPIO1 fired
+VL53L1_Error VL53RulesService(VL53L1_Dev_t* pDev, rules_engine *pEngine)
+{
+	VL53L1_Error Status = VL53L1_ERROR_NONE;
+	VL53L1_RangingMeasurementData_t data;
+	VL53L1_DetectionConfig_t detection;
+	uint8_t i;
+
+	Status = VL53L1_GetRangingMeasurementData(pDev, &data);
+	if (Status != VL53L1_ERROR_NONE)
+		return Status;
+	pEngine->interrupts++;
+
+	for (i = 0; i < pEngine->count; i++)
+	{
+		const rule_def *pRule = &pEngine->pRules[i];
+		uint8_t active = pEngine->active[i];
+
+		if (matches(pRule, active, &data) == active)
+		{
+			pEngine->pending[i] = 0;
+			continue;
+		}
+		if (++pEngine->pending[i] < (active ? pRule->exitFrames : pRule->enterFrames))
+			continue;
+
+		pEngine->pending[i] = 0;
+		pEngine->active[i] = !active;
+		if (pRule->onChange)
+			pRule->onChange(i, pEngine->active[i], &data);
+	}
+
+	//reprogram only when the first stage has to change, otherwise just rearm
+	buildDetection(pEngine, &detection);
+	if (pEngine->hwWindow != (detection.DetectionMode != VL53L1_DETECTION_NORMAL_RUN))
+		return program(pDev, pEngine);
+	return VL53L1_ClearInterruptAndStartMeasurement(pDev);
+}
+
+uint8_t VL53RulesActive(const rules_engine *pEngine, uint8_t rule)
+{
+	return (rule < pEngine->count) ? pEngine->active[rule] : 0;
+}
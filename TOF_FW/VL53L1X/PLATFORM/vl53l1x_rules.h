@@ -0,0 +1,62 @@
+/*
+ * vl53l1x_rules.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: dkupe
+ */
+
+#ifndef VL53L1X_RULES_H_
+#define VL53L1X_RULES_H_
+
+#include "vl53l1x_api.h"
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+//declarative distance rules, e.g. "object within 200-400mm for 3 frames".
+//while every rule is idle the sensor is programmed with a hardware threshold window
+//covering all rules (VL53L1_SetThresholdConfig) and GPIO1 only fires when a rule could
+//trigger. once a rule starts counting or is active the sensor interrupts on every
+//frame so debounce and release can be evaluated, then it goes back to the window.
+
+#define RULES_MAX          8
+
+#define RULE_WITHIN        1	//active while the object is inside [lowMm, highMm]
+#define RULE_OUTSIDE       0	//active while no object is inside [lowMm, highMm]
+
+typedef void (*rule_callback)(uint8_t rule, uint8_t active, const VL53L1_RangingMeasurementData_t *pData);
+
+typedef struct
+{
+	uint16_t lowMm;
+	uint16_t highMm;
+	uint8_t  kind;            //RULE_WITHIN / RULE_OUTSIDE
+	uint8_t  enterFrames;     //matching frames in a row before the rule activates
+	uint8_t  exitFrames;      //non matching frames in a row before it releases
+	uint16_t hysteresisMm;    //window grows (WITHIN) or shrinks (OUTSIDE) by this while active
+	rule_callback onChange;
+}rule_def;
+
+#define RULE_WITHIN_FOR(low, high, frames, cb)   {(low), (high), RULE_WITHIN, (frames), (frames), 0, (cb)}
+#define RULE_OUTSIDE_FOR(low, high, frames, cb)  {(low), (high), RULE_OUTSIDE, (frames), (frames), 0, (cb)}
+
+typedef struct
+{
+	const rule_def *pRules;
+	uint8_t  count;
+	uint8_t  hwWindow;        //1 = threshold window programmed, 0 = every frame interrupts
+	uint8_t  active[RULES_MAX];
+	uint8_t  pending[RULES_MAX];   //frames counted towards the next transition
+	uint32_t interrupts;      //GPIO1 events serviced
+}rules_engine;
+
+VL53L1_Error VL53RulesStart(VL53L1_Dev_t* pDev, rules_engine *pEngine, const rule_def *pRules, uint8_t count);
+VL53L1_Error VL53RulesService(VL53L1_Dev_t* pDev, rules_engine *pEngine);
+uint8_t VL53RulesActive(const rules_engine *pEngine, uint8_t rule);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VL53L1X_RULES_H_ */
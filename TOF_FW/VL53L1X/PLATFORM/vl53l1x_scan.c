@@ -0,0 +1,135 @@
+/*
+ * vl53l1x_scan.c
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: dkupe
+ */
+
+#include "vl53l1x_scan.h"
+
+#define SCAN_SPAD_GRID     16
+#define SCAN_MIN_ROI        4	//smallest ROI the device accepts
+
+//splits the 16x16 SPAD array into cols x rows equal ROIs, row 0 at the top.
+//returns the number of zones written, 0 if the grid is too fine
+uint8_t VL53ScanBuildGrid(scan_zone *pZones, uint8_t cols, uint8_t rows)
+{
+	uint8_t w, h, x, y;
+
+	if (cols == 0 || rows == 0 || cols * rows > SCAN_ZONES_MAX)
+		return 0;
+	w = SCAN_SPAD_GRID / cols;
+	h = SCAN_SPAD_GRID / rows;
+	if (w < SCAN_MIN_ROI || h < SCAN_MIN_ROI)
+		return 0;
+
+	for (y = 0; y < rows; y++)
+	{
+		for (x = 0; x < cols; x++)
+		{
+			scan_zone *pZone = &pZones[y * cols + x];
+
+			//device y axis points up, TopLeftY > BotRightY
+			pZone->roi.TopLeftX = x * w;
+			pZone->roi.BotRightX = x * w + w - 1;
+			pZone->roi.TopLeftY = SCAN_SPAD_GRID - 1 - y * h;
+			pZone->roi.BotRightY = SCAN_SPAD_GRID - y * h - h;
+			pZone->cell = y * cols + x;
+		}
+	}
+	return cols * rows;
+}
+
+//optical centre corrected zone codes, computed once so a switch is a table copy
+void VL53ScanCompile(const roi_lut *pLut, const scan_zone *pZones, uint8_t count, roi_code *pCodes)
+{
+	uint8_t i;
+
+	for (i = 0; i < count; i++)
+		pCodes[i] = VL53RoiEncodeUser(pLut, &pZones[i].roi);
+}
+
+//call after VL53ScanStart, the zone already queued by the start keeps its SetUserROI setup
+void VL53ScanUseCodes(scan_state *pScan, const roi_code *pCodes)
+{
+	pScan->pCodes = pCodes;
+}
+
+static VL53L1_Error programNext(VL53L1_Dev_t* pDev, scan_state *pScan)
+{
+	VL53L1_Error Status = VL53L1_ERROR_NONE;
+	uint8_t zone = pScan->next;
+
+	if (pScan->pCodes)
+		VL53RoiApply(pDev, pScan->pCodes[zone]);
+	else
+		Status = VL53L1_SetUserROI(pDev, (VL53L1_UserRoi_t *)&pScan->pZones[zone].roi);
+	if (Status != VL53L1_ERROR_NONE)
+		return Status;
+
+	memmove(&pScan->inflight[0], &pScan->inflight[1], pScan->depth);
+	pScan->inflight[pScan->depth] = zone;
+	pScan->next = (zone + 1 == pScan->count) ? 0 : zone + 1;
+	return VL53L1_ERROR_NONE;
+}
+
+//the caller picks preset, budget and inter measurement period, depth has to match:
+//SCAN_PIPELINE_TIMED for timed ranging, SCAN_PIPELINE_BACKTOBACK otherwise
+VL53L1_Error VL53ScanStart(VL53L1_Dev_t* pDev, scan_state *pScan, const scan_zone *pZones, uint8_t count, uint8_t depth)
+{
+	VL53L1_Error Status = VL53L1_ERROR_NONE;
+	uint8_t i;
+
+	if (count == 0 || count > SCAN_ZONES_MAX || depth > SCAN_PIPELINE_MAX)
+		return VL53L1_ERROR_INVALID_PARAMS;
+
+	memset(pScan, 0, sizeof(*pScan));
+	pScan->pZones = pZones;
+	pScan->count = count;
+	pScan->depth = depth;
+	for (i = 0; i < SCAN_ZONES_MAX; i++)
+		pScan->status[i] = VL53L1_RANGESTATUS_NONE;
+
+	//zone 0 covers every range already queued before the first reprogram lands
+	Status = VL53L1_StopMeasurement(pDev);
+	if (Status == VL53L1_ERROR_NONE)
+		Status = programNext(pDev, pScan);
+	for (i = 0; i < depth; i++)
+		pScan->inflight[i] = 0;
+	if (Status == VL53L1_ERROR_NONE)
+		Status = VL53L1_StartMeasurement(pDev);
+	return Status;
+}
+
+//call on data ready: read, tag, queue the following zone and restart under GPH
+VL53L1_Error VL53ScanService(VL53L1_Dev_t* pDev, scan_state *pScan, scan_sample *pSample)
+{
+	VL53L1_Error Status = VL53L1_ERROR_NONE;
+	uint8_t zone = pScan->inflight[0];
+	uint8_t cell = pScan->pZones[zone].cell;
+
+	Status = VL53L1_GetRangingMeasurementData(pDev, &pSample->data);
+	if (Status != VL53L1_ERROR_NONE)
+		return Status;
+
+	pSample->zone = zone;
+	pSample->cell = cell;
+	pSample->mapComplete = 0;
+	if (cell < SCAN_ZONES_MAX)
+	{
+		pScan->depthMm[cell] = pSample->data.RangeMilliMeter;
+		pScan->status[cell] = pSample->data.RangeStatus;
+	}
+	pScan->seen |= (uint32_t)1 << zone;
+	if (pScan->seen == (((uint64_t)1 << pScan->count) - 1))
+	{
+		pScan->seen = 0;
+		pScan->maps++;
+		pSample->mapComplete = 1;
+	}
+
+	Status = programNext(pDev, pScan);
+	if (Status == VL53L1_ERROR_NONE)
+		Status = VL53L1_ClearInterruptAndStartMeasurement(pDev);
+	return Status;
+}
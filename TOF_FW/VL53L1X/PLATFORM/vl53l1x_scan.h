@@ -0,0 +1,71 @@
+/*
+ * vl53l1x_scan.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: dkupe
+ */
+
+#ifndef VL53L1X_SCAN_H_
+#define VL53L1X_SCAN_H_
+
+#include "vl53l1x_api.h"
+#include "vl53l1x_roi.h"
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+//multi zone scanning. the ROI for the next range is set with VL53L1_SetUserROI while the
+//current one integrates; VL53L1_ClearInterruptAndStartMeasurement then hands it to the
+//device inside the grouped parameter hold, so ranging never stops between zones.
+//every sample is tagged with the zone it was measured with and written to a coarse
+//depth map (one cell per zone).
+
+#ifndef SCAN_ZONES_MAX
+#define SCAN_ZONES_MAX     16	//<= 32, one bit per zone in scan_state.seen
+#endif
+#define SCAN_PIPELINE_MAX  2
+
+//frames between SetUserROI and the range that uses it
+#define SCAN_PIPELINE_TIMED        0	//timed ranging, next range starts after the clear
+#define SCAN_PIPELINE_BACKTOBACK   1	//next range is already running when the interrupt fires
+
+typedef struct
+{
+	VL53L1_UserRoi_t roi;
+	uint8_t cell;              //index in the depth map
+}scan_zone;
+
+typedef struct
+{
+	uint8_t zone;
+	uint8_t cell;
+	uint8_t mapComplete;       //this sample finished a full pass over all zones
+	VL53L1_RangingMeasurementData_t data;
+}scan_sample;
+
+typedef struct
+{
+	const scan_zone *pZones;
+	const roi_code *pCodes;    //precompiled zones, NULL = go through VL53L1_SetUserROI
+	uint8_t  count;
+	uint8_t  depth;            //SCAN_PIPELINE_xxx
+	uint8_t  next;             //next zone to hand to the device
+	uint8_t  inflight[SCAN_PIPELINE_MAX + 1];
+	uint32_t seen;             //zones measured in the current pass
+	uint32_t maps;             //completed passes
+	int16_t  depthMm[SCAN_ZONES_MAX];
+	uint8_t  status[SCAN_ZONES_MAX];
+}scan_state;
+
+uint8_t VL53ScanBuildGrid(scan_zone *pZones, uint8_t cols, uint8_t rows);
+void VL53ScanCompile(const roi_lut *pLut, const scan_zone *pZones, uint8_t count, roi_code *pCodes);
+VL53L1_Error VL53ScanStart(VL53L1_Dev_t* pDev, scan_state *pScan, const scan_zone *pZones, uint8_t count, uint8_t depth);
+void VL53ScanUseCodes(scan_state *pScan, const roi_code *pCodes);
+VL53L1_Error VL53ScanService(VL53L1_Dev_t* pDev, scan_state *pScan, scan_sample *pSample);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VL53L1X_SCAN_H_ */
@@ -0,0 +1,115 @@
+/*
+ * vl53l1x_sharedirq.c
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: dkupe
+ */
+
+#include "vl53l1x_sharedirq.h"
+#include "vl53l1x_platform.h"
+#include <stdio.h>
+
+#define INT_STATUS_MASK   0x07	//RESULT__INTERRUPT_STATUS int_status, 0 = cleared
+
+void VL53SharedIrqInit(sharedirq_state *pState, GPIO_TypeDef *port, uint16_t pin,
+		VL53L1_Error (*service)(uint8_t idx, VL53L1_Dev_t* pDev))
+{
+	memset(pState, 0, sizeof(*pState));
+	pState->port = port;
+	pState->pin = pin;
+	pState->service = service;
+}
+
+//puts GPIO1 of the device to active low, call before the device starts ranging
+int8_t VL53SharedIrqAdd(sharedirq_state *pState, VL53L1_Dev_t* pDev, uint32_t periodUs)
+{
+	irq_source *pSrc;
+	uint8_t idx;
+
+	//a device that is already on the line (reinit) keeps its slot
+	for (idx = 0; idx < pState->count && pState->src[idx].pDev != pDev; idx++)
+		;
+	if (idx >= SHAREDIRQ_MAX)
+		return -1;
+	if (VL53L1_set_interrupt_polarity(pDev, VL53L1_DEVICEINTERRUPTPOLARITY_ACTIVE_LOW) != VL53L1_ERROR_NONE)
+		return -1;
+	pSrc = &pState->src[idx];
+	memset(pSrc, 0, sizeof(*pSrc));
+	pSrc->pDev = pDev;
+	pSrc->periodUs = periodUs;
+	if (idx == pState->count)
+		pState->count++;
+	return (int8_t)idx;
+}
+
+static uint8_t lineAsserted(const sharedirq_state *pState)
+{
+	return HAL_GPIO_ReadPin(pState->port, pState->pin) == GPIO_PIN_RESET;
+}
+
+//most overdue first, insertion sort, the list is short
+static void order(const sharedirq_state *pState, uint32_t irqUs, uint8_t *pOrder)
+{
+	uint8_t i, j;
+
+	for (i = 0; i < pState->count; i++)
+	{
+		int32_t due = (int32_t)(pState->src[i].nextUs - irqUs);
+
+		for (j = i; j > 0 && (int32_t)(pState->src[pOrder[j - 1]].nextUs - irqUs) > due; j--)
+			pOrder[j] = pOrder[j - 1];
+		pOrder[j] = i;
+	}
+}
+
+static void learn(irq_source *pSrc, uint32_t irqUs)
+{
+	uint32_t last = pSrc->nextUs - pSrc->periodUs;
+	uint32_t period = irqUs - last;
+
+	//only a plausible single period refines the estimate, a missed frame does not
+	if (pSrc->serviced && period > pSrc->periodUs / 2 && period < pSrc->periodUs * 3 / 2)
+		pSrc->periodUs += ((int32_t)period - (int32_t)pSrc->periodUs) / 4;
+	pSrc->nextUs = irqUs + pSrc->periodUs;
+	pSrc->serviced++;
+}
+
+//from the main loop after the EXTI edge, returns the number of sensors serviced
+uint8_t VL53SharedIrqService(sharedirq_state *pState, uint32_t irqUs)
+{
+	uint8_t orderIdx[SHAREDIRQ_MAX];
+	uint8_t pass, i, status, serviced = 0;
+
+	pState->events++;
+	order(pState, irqUs, orderIdx);
+	for (pass = 0; pass < SHAREDIRQ_PASSES && lineAsserted(pState); pass++)
+	{
+		for (i = 0; i < pState->count; i++)
+		{
+			irq_source *pSrc = &pState->src[orderIdx[i]];
+
+			pState->reads++;
+			if (VL53L1_RdByte(pSrc->pDev, VL53L1_RESULT__INTERRUPT_STATUS, &status) != VL53L1_ERROR_NONE ||
+					!(status & INT_STATUS_MASK))
+				continue;
+			learn(pSrc, irqUs);
+			if (pState->service)
+				pState->service(orderIdx[i], pSrc->pDev);
+			serviced++;
+			if (!lineAsserted(pState))
+				break;
+		}
+	}
+	if (serviced == 0)
+		pState->spurious++;
+	if (lineAsserted(pState))
+		pState->stuck++;
+	return serviced;
+}
+
+//IRQ,events,status reads,spurious,stuck
+int VL53SharedIrqFormat(char *buf, size_t len, const sharedirq_state *pState)
+{
+	return snprintf(buf, len, "IRQ,%lu,%lu,%lu,%lu\r\n", (unsigned long)pState->events,
+			(unsigned long)pState->reads, (unsigned long)pState->spurious, (unsigned long)pState->stuck);
+}
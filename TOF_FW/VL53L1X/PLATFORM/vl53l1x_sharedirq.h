@@ -0,0 +1,65 @@
+/*
+ * vl53l1x_sharedirq.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: dkupe
+ */
+
+#ifndef VL53L1X_SHAREDIRQ_H_
+#define VL53L1X_SHAREDIRQ_H_
+
+#include "vl53l1x_api.h"
+#include "vl53l1x_api_core.h"
+#include "main.h"
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+//all GPIO1 outputs on one wired-OR line, active low with a pull-up, one EXTI pin for any
+//number of sensors. on an edge VL53SharedIrqService() reads RESULT__INTERRUPT_STATUS
+//(one byte) of the sensors in order of expected completion, most overdue first, and
+//hands each pending one to the service callback, which has to read and clear it. the
+//line is sampled after every serviced sensor: once it is released nothing else is
+//pending and no further status is read. a sensor that asserts while the line is still
+//low makes no new edge, so passes repeat while the line stays low.
+//VL53SharedIrqAdd() of a device that is already on the line restarts its slot, the
+//index and the other sensors stay as they are.
+
+#ifndef SHAREDIRQ_MAX
+#define SHAREDIRQ_MAX      16
+#endif
+#define SHAREDIRQ_PASSES   3
+
+typedef struct
+{
+	VL53L1_Dev_t *pDev;
+	uint32_t periodUs;         //expected frame period, refined from the service times
+	uint32_t nextUs;           //expected completion
+	uint32_t serviced;
+}irq_source;
+
+typedef struct
+{
+	irq_source src[SHAREDIRQ_MAX];
+	uint8_t  count;
+	GPIO_TypeDef *port;
+	uint16_t pin;
+	VL53L1_Error (*service)(uint8_t idx, VL53L1_Dev_t* pDev);
+	uint32_t events;
+	uint32_t reads;            //status reads
+	uint32_t spurious;         //edges with nothing pending
+	uint32_t stuck;            //line still low after all passes
+}sharedirq_state;
+
+void VL53SharedIrqInit(sharedirq_state *pState, GPIO_TypeDef *port, uint16_t pin,
+		VL53L1_Error (*service)(uint8_t idx, VL53L1_Dev_t* pDev));
+int8_t VL53SharedIrqAdd(sharedirq_state *pState, VL53L1_Dev_t* pDev, uint32_t periodUs);
+uint8_t VL53SharedIrqService(sharedirq_state *pState, uint32_t irqUs);
+int VL53SharedIrqFormat(char *buf, size_t len, const sharedirq_state *pState);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VL53L1X_SHAREDIRQ_H_ */
@@ -0,0 +1,169 @@
+/*
+ * vl53l1x_sync.c
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: dkupe
+ */
+
+#include "vl53l1x_sync.h"
+#include "vl53l1x_platform.h"
+#include "timebase.h"
+#include <stdio.h>
+
+//the sensors have to be started (VL53L1_SetInterMeasurementPeriodMilliSeconds with
+//periodMs, timed ranging) before their first frame is reported
+void VL53SyncInit(sync_state *pSync, uint32_t periodMs, uint32_t slotUs, uint16_t lockUs)
+{
+	memset(pSync, 0, sizeof(*pSync));
+	pSync->periodUs = periodMs * 1000;
+	pSync->slotUs = slotUs;
+	pSync->lockUs = lockUs;
+	pSync->epochUs = Timebase_Us();
+}
+
+int8_t VL53SyncAdd(sync_state *pSync, VL53L1_Dev_t* pDev)
+{
+	if (pSync->count >= SYNC_SENSORS_MAX)
+		return -1;
+	memset(&pSync->sensor[pSync->count], 0, sizeof(sync_sensor));
+	pSync->sensor[pSync->count].pDev = pDev;
+	return (int8_t)pSync->count++;
+}
+
+//error against epoch + idx * slot, folded into one period. the epoch follows the frames
+//in whole periods, so the difference stays small and the 32 bit us count can wrap
+static int32_t phaseOf(sync_state *pSync, uint8_t idx, uint32_t readyUs)
+{
+	int32_t period = (int32_t)pSync->periodUs;
+	int32_t phase = (int32_t)(readyUs - pSync->epochUs - idx * pSync->slotUs);
+
+	if (phase > period / 2)
+	{
+		uint32_t periods = (uint32_t)(phase + period / 2) / pSync->periodUs;
+
+		pSync->epochUs += periods * pSync->periodUs;
+		phase -= (int32_t)(periods * pSync->periodUs);
+	}
+	while (phase <= -period / 2)
+		phase += period;
+	return phase;
+}
+
+//the period already running cannot be changed, its end is the expected phase. the
+//SYNC_ADJUST_FRAMES periods after it take 1/SYNC_PHASE_DIV of that out, converted to
+//register counts with the learned count length, so the oscillator error cancels out
+static VL53L1_Error adjust(sync_state *pSync, sync_sensor *pSensor)
+{
+	VL53L1_LLDriverData_t *pLL = VL53L1DevStructGetLLDriverHandle(pSensor->pDev);
+	int32_t maxStep = (int32_t)(pSync->periodUs / SYNC_STEP_DIV);
+	uint32_t runUs = (uint32_t)(((uint64_t)pSensor->regRun * pSensor->countQ20 + (1 << 19)) >> 20);
+	int32_t expect = pSensor->phaseUs + (int32_t)(runUs - pSync->periodUs);
+	int32_t step = expect / (SYNC_PHASE_DIV * SYNC_ADJUST_FRAMES);
+	uint32_t wantUs, reg;
+
+	if (step > maxStep)
+		step = maxStep;
+	else if (step < -maxStep)
+		step = -maxStep;
+	wantUs = pSync->periodUs - step;
+	reg = (uint32_t)((((uint64_t)wantUs << 20) + pSensor->countQ20 / 2) / pSensor->countQ20);
+	if (reg == pSensor->regNext)
+		return VL53L1_ERROR_NONE;
+	pLL->tim_cfg.system__intermeasurement_period = reg;
+	pSensor->regNext = reg;
+	pSensor->adjustments++;
+	//picked up by the device at the start of the next period
+	return VL53L1_WrDWord(pSensor->pDev, VL53L1_SYSTEM__INTERMEASUREMENT_PERIOD, reg);
+}
+
+static void learn(sync_sensor *pSensor, uint32_t intervalUs, uint8_t gap)
+{
+	uint32_t countQ20;
+
+	pSensor->periodQ4 = pSensor->periodQ4 ? pSensor->periodQ4 + (((int32_t)((intervalUs << 4) / gap) -
+			(int32_t)pSensor->periodQ4) >> 2) : (intervalUs << 4) / gap;
+	if (pSensor->regRun == 0)
+		return;
+	//a gap spans periods that may have run with other values, the error fades out
+	countQ20 = (uint32_t)(((uint64_t)intervalUs << 20) / ((uint64_t)pSensor->regRun * gap));
+	if (pSensor->countQ20 == 0)
+		pSensor->countQ20 = countQ20;
+	else
+		pSensor->countQ20 += (int32_t)((int64_t)countQ20 - pSensor->countQ20) >> SYNC_LEARN_SHIFT;
+}
+
+//call for every frame with the GPIO1 time and the StreamCount of the frame
+VL53L1_Error VL53SyncFrame(sync_state *pSync, uint8_t idx, uint32_t readyUs, uint8_t streamCount)
+{
+	VL53L1_LLDriverData_t *pLL;
+	sync_sensor *pSensor;
+	uint8_t gap = 1;
+
+	if (idx >= pSync->count)
+		return VL53L1_ERROR_INVALID_PARAMS;
+	pSensor = &pSync->sensor[idx];
+	pLL = VL53L1DevStructGetLLDriverHandle(pSensor->pDev);
+	if (pSensor->started)
+	{
+		//stream count wraps 255 -> 128
+		gap = (uint8_t)(streamCount - pSensor->lastStream);
+		if (streamCount < pSensor->lastStream)
+			gap -= 128;
+		if (gap == 0)
+			gap = 1;
+		pSensor->missed += gap - 1;
+		learn(pSensor, readyUs - pSensor->lastUs, gap);
+		//the period that ran with the last write has started now
+		pSensor->regRun = pSensor->regNext;
+	}
+	else
+	{
+		//the period up to the next frame runs with what the driver wrote at start
+		pSensor->regRun = pLL->tim_cfg.system__intermeasurement_period;
+		pSensor->regNext = pSensor->regRun;
+	}
+	pSensor->started = 1;
+	pSensor->lastUs = readyUs;
+	pSensor->lastStream = streamCount;
+	pSensor->phaseUs = phaseOf(pSync, idx, readyUs);
+
+	if (pSensor->countQ20 == 0 || ++pSensor->frames < SYNC_ADJUST_FRAMES)
+		return VL53L1_ERROR_NONE;
+	pSensor->frames = 0;
+	return adjust(pSync, pSensor);
+}
+
+uint8_t VL53SyncLocked(const sync_state *pSync)
+{
+	uint8_t i;
+
+	for (i = 0; i < pSync->count; i++)
+	{
+		int32_t phase = pSync->sensor[i].phaseUs;
+
+		if (!pSync->sensor[i].started || phase > pSync->lockUs || phase < -(int32_t)pSync->lockUs)
+			return 0;
+	}
+	return pSync->count != 0;
+}
+
+//start of the next master frame (sensor 0 ready) after nowUs, for scheduling the readouts.
+//the epoch can be up to half a period ahead of the last frame
+uint32_t VL53SyncNextUs(const sync_state *pSync, uint32_t nowUs)
+{
+	int32_t since = (int32_t)(nowUs - pSync->epochUs);
+
+	if (since < 0)
+		return pSync->epochUs;
+	return nowUs + pSync->periodUs - (uint32_t)since % pSync->periodUs;
+}
+
+//SYN,idx,period us,phase us,adjustments,missed
+int VL53SyncFormat(char *buf, size_t len, const sync_state *pSync, uint8_t idx)
+{
+	const sync_sensor *pSensor = &pSync->sensor[idx];
+
+	return snprintf(buf, len, "SYN,%u,%lu,%ld,%lu,%lu\r\n", idx,
+			(unsigned long)((pSensor->periodQ4 + 8) >> 4), (long)pSensor->phaseUs,
+			(unsigned long)pSensor->adjustments, (unsigned long)pSensor->missed);
+}
@@ -0,0 +1,72 @@
+/*
+ * vl53l1x_sync.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: dkupe
+ */
+
+#ifndef VL53L1X_SYNC_H_
+#define VL53L1X_SYNC_H_
+
+#include "vl53l1x_api.h"
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+//frame phase lock for several sensors in timed ranging. every sensor counts its inter
+//measurement period on its own oscillator, so frames slide against each other. each
+//data ready time (TIM2 us) and StreamCount, against the register value the period ran
+//with, give the length of one register count. every SYNC_ADJUST_FRAMES frames
+//SYSTEM__INTERMEASUREMENT_PERIOD is set so the periods up to the next adjustment take
+//1/SYNC_PHASE_DIV of the phase error out that is expected once the period already
+//running is over. sensor i is locked to epoch + i * slotUs, a slot a bit longer than one
+//readout puts the readouts back to back on the bus. all sensors run the same period.
+//test/test_sync.c runs the loop against a model with +-5% oscillators.
+
+#ifndef SYNC_SENSORS_MAX
+#define SYNC_SENSORS_MAX    8
+#endif
+#define SYNC_ADJUST_FRAMES  4
+#define SYNC_PHASE_DIV      2	//part of the phase error removed per adjustment
+#define SYNC_STEP_DIV       16	//max period change per adjustment, 1/16
+#define SYNC_LEARN_SHIFT    3	//EWMA weight of the count length, 1/8
+
+typedef struct
+{
+	VL53L1_Dev_t *pDev;
+	uint32_t lastUs;
+	uint8_t  lastStream;
+	uint8_t  started;
+	uint8_t  frames;           //since the last adjustment
+	uint32_t periodQ4;         //measured period, us Q4, EWMA
+	uint32_t countQ20;         //length of one register count, us Q20, EWMA
+	uint32_t regRun;           //register value of the period running now
+	uint32_t regNext;          //register value of the period after it
+	int32_t  phaseUs;          //last error against the schedule, + = late
+	uint32_t adjustments;
+	uint32_t missed;           //frames lost according to StreamCount
+}sync_sensor;
+
+typedef struct
+{
+	sync_sensor sensor[SYNC_SENSORS_MAX];
+	uint8_t  count;
+	uint32_t periodUs;         //master period
+	uint32_t slotUs;
+	uint32_t epochUs;
+	uint16_t lockUs;           //|phase| below this counts as locked
+}sync_state;
+
+void VL53SyncInit(sync_state *pSync, uint32_t periodMs, uint32_t slotUs, uint16_t lockUs);
+int8_t VL53SyncAdd(sync_state *pSync, VL53L1_Dev_t* pDev);
+VL53L1_Error VL53SyncFrame(sync_state *pSync, uint8_t idx, uint32_t readyUs, uint8_t streamCount);
+uint8_t VL53SyncLocked(const sync_state *pSync);
+uint32_t VL53SyncNextUs(const sync_state *pSync, uint32_t nowUs);
+int VL53SyncFormat(char *buf, size_t len, const sync_state *pSync, uint8_t idx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VL53L1X_SYNC_H_ */
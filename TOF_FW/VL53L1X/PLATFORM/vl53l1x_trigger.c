@@ -0,0 +1,125 @@
+/*
+ * vl53l1x_trigger.c
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: dkupe
+ */
+
+#include "vl53l1x_trigger.h"
+#include "vl53l1x_xfer.h"
+#include "timebase.h"
+#include <stdio.h>
+
+//the first range is started by the configuration write itself, the timer takes over
+//from the next tick. budget, distance mode and ROI have to be set before
+VL53L1_Error VL53TriggerStart(VL53L1_Dev_t* pDev, trigger_state *pState, TIM_HandleTypeDef *htim, uint32_t periodUs)
+{
+	VL53L1_LLDriverData_t *pLL = VL53L1DevStructGetLLDriverHandle(pDev);
+	VL53L1_Error Status = VL53L1_ERROR_NONE;
+
+	if (periodUs < 2 || periodUs > 0x10000)
+		return VL53L1_ERROR_INVALID_PARAMS;
+	memset(pState, 0, sizeof(*pState));
+	pState->pDev = pDev;
+	pState->htim = htim;
+	pState->minPeriodUs = 0xFFFFFFFF;
+
+	Status = VL53L1_init_and_start_range(pDev, VL53L1_DEVICEMEASUREMENTMODE_SINGLESHOT,
+			VL53L1_DEVICECONFIGLEVEL_FULL);
+	if (Status != VL53L1_ERROR_NONE)
+		return Status;
+	pState->startCmd[0] = 0x01;	//clear range interrupt
+	pState->startCmd[1] = pLL->sys_ctrl.system__mode_start;
+	pState->triggerUs = Timebase_Us();
+	pState->lastTriggerUs = pState->triggerUs;
+
+	__HAL_TIM_SET_AUTORELOAD(htim, periodUs - 1);
+	__HAL_TIM_SET_COUNTER(htim, 0);
+	pState->running = 1;
+	if (HAL_TIM_Base_Start_IT(htim) != HAL_OK)
+	{
+		pState->running = 0;
+		return VL53L1_ERROR_CONTROL_INTERFACE;
+	}
+	return Status;
+}
+
+void VL53TriggerStop(trigger_state *pState)
+{
+	HAL_TIM_Base_Stop_IT(pState->htim);
+	pState->running = 0;
+	VL53L1_StopMeasurement(pState->pDev);
+}
+
+//timer update interrupt, keep it above every other user of the bus
+void VL53TriggerTick(trigger_state *pState)
+{
+	VL53L1_Dev_t *pDev = pState->pDev;
+	uint32_t nowUs, periodUs;
+
+	if (!pState->running)
+		return;
+	if (pState->readout || pState->pending)
+	{
+		pState->skipped++;
+		return;
+	}
+	nowUs = Timebase_Us();
+	if (VL53XferWritePolled(pDev->I2cHandle, pDev->I2cDevAddr, VL53L1_SYSTEM__INTERRUPT_CLEAR,
+			pState->startCmd, sizeof(pState->startCmd)) != VL53L1_ERROR_NONE)
+	{
+		pState->failed++;
+		return;
+	}
+	periodUs = nowUs - pState->lastTriggerUs;
+	if (pState->triggers)
+	{
+		if (periodUs < pState->minPeriodUs)
+			pState->minPeriodUs = periodUs;
+		if (periodUs > pState->maxPeriodUs)
+			pState->maxPeriodUs = periodUs;
+	}
+	pState->lastTriggerUs = nowUs;
+	pState->triggerUs = nowUs;
+	pState->triggers++;
+}
+
+//GPIO1 interrupt
+void VL53TriggerDataReady(trigger_state *pState)
+{
+	if (pState->running)
+		pState->pending = 1;
+}
+
+//main loop, *pNew = 1 when pData holds a new frame, TimeStamp is the trigger time in us
+VL53L1_Error VL53TriggerService(trigger_state *pState, VL53L1_RangingMeasurementData_t *pData, uint8_t *pNew)
+{
+	VL53L1_Error Status = VL53L1_ERROR_NONE;
+
+	*pNew = 0;
+	if (!pState->pending)
+		return Status;
+	pState->readout = 1;
+	Status = VL53L1_GetRangingMeasurementData(pState->pDev, pData);
+	pState->readout = 0;
+	pState->pending = 0;
+	if (Status == VL53L1_ERROR_NONE)
+	{
+		pData->TimeStamp = pState->triggerUs;
+		pState->frames++;
+		*pNew = 1;
+	}
+	return Status;
+}
+
+//TRG,triggers,frames,skipped,failed,min period us,max period us, resets the period window
+int VL53TriggerFormat(char *buf, size_t len, trigger_state *pState)
+{
+	int n = snprintf(buf, len, "TRG,%lu,%lu,%lu,%lu,%lu,%lu\r\n", (unsigned long)pState->triggers,
+			(unsigned long)pState->frames, (unsigned long)pState->skipped, (unsigned long)pState->failed,
+			(unsigned long)(pState->maxPeriodUs ? pState->minPeriodUs : 0), (unsigned long)pState->maxPeriodUs);
+
+	pState->minPeriodUs = 0xFFFFFFFF;
+	pState->maxPeriodUs = 0;
+	return n;
+}
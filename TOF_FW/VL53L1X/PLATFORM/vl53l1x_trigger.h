@@ -0,0 +1,59 @@
+/*
+ * vl53l1x_trigger.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: dkupe
+ */
+
+#ifndef VL53L1X_TRIGGER_H_
+#define VL53L1X_TRIGGER_H_
+
+#include "vl53l1x_api.h"
+#include "vl53l1x_api_core.h"
+#include "main.h"
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+//fixed rate sampling: a timer update interrupt starts each single shot range, so the
+//sample period has the jitter of the timer interrupt instead of the drift of free
+//running ranging. VL53TriggerStart() loads the full single shot configuration once,
+//after that a trigger is one 2 byte write at SYSTEM__INTERRUPT_CLEAR (clear + mode
+//start are adjacent), done with register polling from the timer interrupt.
+//the result is read in the main loop after the GPIO1 interrupt. a tick that finds the
+//readout still running or the last frame not collected is skipped and counted.
+//period must be longer than the timing budget plus the readout.
+//the timer interrupt has to be less urgent than SysTick, the polled write times out on
+//HAL_GetTick(). the caller sets readout while it recovers the device, so no tick writes.
+
+typedef struct
+{
+	VL53L1_Dev_t *pDev;
+	TIM_HandleTypeDef *htim;       //1 MHz counter, update interrupt
+	uint8_t  startCmd[2];          //SYSTEM__INTERRUPT_CLEAR, SYSTEM__MODE_START
+	volatile uint8_t running;
+	volatile uint8_t readout;      //main loop is on the bus
+	volatile uint8_t pending;      //frame ready, not collected yet
+	uint32_t triggerUs;            //last trigger, the capture time of the next frame
+	uint32_t lastTriggerUs;
+	uint32_t minPeriodUs;
+	uint32_t maxPeriodUs;
+	uint32_t triggers;
+	uint32_t skipped;
+	uint32_t failed;               //start write not acknowledged
+	uint32_t frames;
+}trigger_state;
+
+VL53L1_Error VL53TriggerStart(VL53L1_Dev_t* pDev, trigger_state *pState, TIM_HandleTypeDef *htim, uint32_t periodUs);
+void VL53TriggerStop(trigger_state *pState);
+void VL53TriggerTick(trigger_state *pState);
+void VL53TriggerDataReady(trigger_state *pState);
+VL53L1_Error VL53TriggerService(trigger_state *pState, VL53L1_RangingMeasurementData_t *pData, uint8_t *pNew);
+int VL53TriggerFormat(char *buf, size_t len, trigger_state *pState);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VL53L1X_TRIGGER_H_ */
@@ -0,0 +1,172 @@
+/*
+ * vl53l1x_tuning.c
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: dkupe
+ */
+
+#include "vl53l1x_tuning.h"
+
+static void put16(uint8_t *p, uint16_t v)
+{
+	p[0] = (uint8_t)v;
+	p[1] = (uint8_t)(v >> 8);
+}
+
+static void put32(uint8_t *p, uint32_t v)
+{
+	put16(p, (uint16_t)v);
+	put16(p + 2, (uint16_t)(v >> 16));
+}
+
+static uint16_t get16(const uint8_t *p)
+{
+	return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t get32(const uint8_t *p)
+{
+	return get16(p) | ((uint32_t)get16(p + 2) << 16);
+}
+
+//nibble table, 64 bytes of flash instead of 1k
+uint32_t VL53TuneCrc(const uint8_t *pData, uint32_t len)
+{
+	static const uint32_t table[16] =
+	{
+		0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+		0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+	};
+	uint32_t crc = 0xFFFFFFFF;
+
+	while (len--)
+	{
+		crc ^= *pData++;
+		crc = (crc >> 4) ^ table[crc & 0x0F];
+		crc = (crc >> 4) ^ table[crc & 0x0F];
+	}
+	return ~crc;
+}
+
+//returns the profile size, 0 if buf is too small
+uint32_t VL53TuneBuild(uint8_t *buf, uint32_t len, uint16_t keyTable, uint16_t version,
+		const tune_entry *pEntries, uint16_t count)
+{
+	uint32_t size = TUNE_SIZE((uint32_t)count);
+	uint8_t *p = buf + TUNE_HEADER_SIZE;
+	uint16_t i;
+
+	if (len < size)
+		return 0;
+	put32(buf, TUNE_MAGIC);
+	buf[4] = TUNE_FORMAT;
+	buf[5] = 0;
+	put16(buf + 6, keyTable);
+	put16(buf + 8, count);
+	put16(buf + 10, version);
+	for (i = 0; i < count; i++, p += TUNE_ENTRY_SIZE)
+	{
+		put16(p, pEntries[i].id);
+		put32(p + 2, (uint32_t)pEntries[i].value);
+	}
+	put32(p, VL53TuneCrc(buf, size - TUNE_CRC_SIZE));
+	return size;
+}
+
+//checks framing and CRC only, the keys are checked against the device in VL53TuneApply()
+VL53L1_Error VL53TuneParse(const uint8_t *buf, uint32_t len, tune_profile *pProfile)
+{
+	uint32_t size;
+
+	if (len < TUNE_SIZE(0) || get32(buf) != TUNE_MAGIC || buf[4] != TUNE_FORMAT)
+		return VL53L1_ERROR_INVALID_PARAMS;
+	pProfile->format = buf[4];
+	pProfile->keyTable = get16(buf + 6);
+	pProfile->count = get16(buf + 8);
+	pProfile->version = get16(buf + 10);
+	pProfile->pEntries = buf + TUNE_HEADER_SIZE;
+	size = TUNE_SIZE((uint32_t)pProfile->count);
+	if (len < size)
+		return VL53L1_ERROR_INVALID_PARAMS;
+	if (get32(buf + size - TUNE_CRC_SIZE) != VL53TuneCrc(buf, size - TUNE_CRC_SIZE))
+		return VL53L1_ERROR_INVALID_PARAMS;
+	return VL53L1_ERROR_NONE;
+}
+
+void VL53TuneEntry(const tune_profile *pProfile, uint16_t index, tune_entry *pEntry)
+{
+	const uint8_t *p = pProfile->pEntries + (uint32_t)index * TUNE_ENTRY_SIZE;
+
+	pEntry->id = get16(p);
+	pEntry->value = (int32_t)get32(p + 2);
+}
+
+//the tuning parms only live in the driver's RAM copy and are sent to the device with the
+//next preset/StaticInit, so applying is cheap; what matters is that a bad profile changes
+//nothing. every key is read back first (unknown keys fail there), only then is it written.
+VL53L1_Error VL53TuneApply(VL53L1_Dev_t* pDev, const uint8_t *buf, uint32_t len)
+{
+	VL53L1_Error Status;
+	tune_profile profile;
+	tune_entry entry;
+	int32_t value;
+	uint16_t i;
+
+	Status = VL53TuneParse(buf, len, &profile);
+	if (Status == VL53L1_ERROR_NONE)
+		Status = VL53L1_get_tuning_parm(pDev, VL53L1_TUNINGPARM_KEY_TABLE_VERSION, &value);
+	if (Status == VL53L1_ERROR_NONE && value != profile.keyTable)
+		Status = VL53L1_ERROR_TUNING_PARM_KEY_MISMATCH;
+
+	for (i = 0; i < profile.count && Status == VL53L1_ERROR_NONE; i++)
+	{
+		VL53TuneEntry(&profile, i, &entry);
+		//version keys describe the table itself, a profile does not get to change them
+		if (entry.id == VL53L1_TUNINGPARM_VERSION || entry.id == VL53L1_TUNINGPARM_KEY_TABLE_VERSION ||
+				entry.id == VL53L1_TUNINGPARM_LLD_VERSION)
+			Status = VL53L1_ERROR_INVALID_PARAMS;
+		else
+			Status = VL53L1_get_tuning_parm(pDev, entry.id, &value);
+	}
+
+	for (i = 0; i < profile.count && Status == VL53L1_ERROR_NONE; i++)
+	{
+		VL53TuneEntry(&profile, i, &entry);
+		Status = VL53L1_set_tuning_parm(pDev, entry.id, entry.value);
+	}
+	return Status;
+}
+
+//profile of the current values of the given keys, e.g. to save a field-tuned device
+VL53L1_Error VL53TuneCapture(VL53L1_Dev_t* pDev, const uint16_t *pIds, uint16_t count,
+		uint16_t version, uint8_t *buf, uint32_t len, uint32_t *pSize)
+{
+	VL53L1_Error Status;
+	int32_t keyTable, value;
+	uint8_t *p = buf + TUNE_HEADER_SIZE;
+	uint16_t i;
+
+	*pSize = 0;
+	if (len < TUNE_SIZE((uint32_t)count))
+		return VL53L1_ERROR_INVALID_PARAMS;
+	Status = VL53L1_get_tuning_parm(pDev, VL53L1_TUNINGPARM_KEY_TABLE_VERSION, &keyTable);
+	//entries are written in place, header and CRC follow once all of them were read
+	for (i = 0; i < count && Status == VL53L1_ERROR_NONE; i++, p += TUNE_ENTRY_SIZE)
+	{
+		Status = VL53L1_get_tuning_parm(pDev, pIds[i], &value);
+		put16(p, pIds[i]);
+		put32(p + 2, (uint32_t)value);
+	}
+	if (Status == VL53L1_ERROR_NONE)
+	{
+		put32(buf, TUNE_MAGIC);
+		buf[4] = TUNE_FORMAT;
+		buf[5] = 0;
+		put16(buf + 6, (uint16_t)keyTable);
+		put16(buf + 8, count);
+		put16(buf + 10, version);
+		*pSize = TUNE_SIZE((uint32_t)count);
+		put32(p, VL53TuneCrc(buf, *pSize - TUNE_CRC_SIZE));
+	}
+	return Status;
+}
@@ -0,0 +1,66 @@
+/*
+ * vl53l1x_tuning.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: dkupe
+ */
+
+#ifndef VL53L1X_TUNING_H_
+#define VL53L1X_TUNING_H_
+
+#include "vl53l1x_api.h"
+#include "vl53l1x_api_core.h"
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+//binary tuning profile, stored in flash or received over UART and applied in one call.
+//little endian, no padding, so the same bytes come out of a host build:
+//  0  uint32 magic            TUNE_MAGIC
+//  4  uint8  format           TUNE_FORMAT
+//  5  uint8  reserved         0
+//  6  uint16 keyTable         VL53L1_TUNINGPARM_KEY_TABLE_VERSION the profile was made for
+//  8  uint16 count            number of entries
+// 10  uint16 version          profile version, free for the application
+// 12  count x {uint16 id, int32 value}
+//  n  uint32 crc              CRC-32 (IEEE, same as zlib) over bytes 0..n-1
+//VL53TuneBuild() only touches the buffer and builds on the host as well, tools/tunegen
+//uses it to make profiles from a text file.
+
+#define TUNE_MAGIC          0x50544C56	//"VLTP"
+#define TUNE_FORMAT         1
+#define TUNE_HEADER_SIZE    12
+#define TUNE_ENTRY_SIZE     6
+#define TUNE_CRC_SIZE       4
+#define TUNE_SIZE(count)    (TUNE_HEADER_SIZE + (count) * TUNE_ENTRY_SIZE + TUNE_CRC_SIZE)
+
+typedef struct
+{
+	uint16_t id;               //VL53L1_TUNINGPARM_xxx
+	int32_t  value;
+}tune_entry;
+
+typedef struct
+{
+	uint8_t  format;
+	uint16_t keyTable;
+	uint16_t count;
+	uint16_t version;
+	const uint8_t *pEntries;
+}tune_profile;
+
+uint32_t VL53TuneCrc(const uint8_t *pData, uint32_t len);
+uint32_t VL53TuneBuild(uint8_t *buf, uint32_t len, uint16_t keyTable, uint16_t version,
+		const tune_entry *pEntries, uint16_t count);
+VL53L1_Error VL53TuneParse(const uint8_t *buf, uint32_t len, tune_profile *pProfile);
+void VL53TuneEntry(const tune_profile *pProfile, uint16_t index, tune_entry *pEntry);
+VL53L1_Error VL53TuneApply(VL53L1_Dev_t* pDev, const uint8_t *buf, uint32_t len);
+VL53L1_Error VL53TuneCapture(VL53L1_Dev_t* pDev, const uint16_t *pIds, uint16_t count,
+		uint16_t version, uint8_t *buf, uint32_t len, uint32_t *pSize);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VL53L1X_TUNING_H_ */
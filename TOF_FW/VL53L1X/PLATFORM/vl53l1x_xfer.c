@@ -0,0 +1,308 @@
+/*
+ * vl53l1x_xfer.c
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: dkupe
+ */
+
+#include "vl53l1x_xfer.h"
+#include "stm32f1xx_ll_i2c.h"
+#include "timebase.h"
+#include <stdio.h>
+
+#define XFER_SR1_ERRORS   (I2C_SR1_AF | I2C_SR1_BERR | I2C_SR1_ARLO)
+
+xfer_state xferState =
+{
+	.pollMax = XFER_POLL_MAX_DEFAULT,
+};
+
+static const uint16_t benchSizes[XFER_BENCH_SIZES] = {1, 2, 4, 6, 8, 12, 24, 44};
+
+//busy waits on SR1, gives up on NACK, bus error, arbitration loss or timeout
+static uint8_t waitSr1(I2C_TypeDef *I2Cx, uint32_t flag, uint32_t start)
+{
+	while (!(I2Cx->SR1 & flag))
+	{
+		if ((I2Cx->SR1 & XFER_SR1_ERRORS) || HAL_GetTick() - start > XFER_TIMEOUT_MS)
+			return 0;
+	}
+	return 1;
+}
+
+static VL53L1_Error abortPolled(I2C_TypeDef *I2Cx)
+{
+	I2Cx->SR1 &= ~XFER_SR1_ERRORS;
+	LL_I2C_GenerateStopCondition(I2Cx);
+	LL_I2C_DisableBitPOS(I2Cx);
+	LL_I2C_AcknowledgeNextData(I2Cx, LL_I2C_ACK);
+	return VL53L1_ERROR_CONTROL_INTERFACE;
+}
+
+//START, address for write, 16 bit index
+static uint8_t sendHeader(I2C_TypeDef *I2Cx, uint8_t address, uint16_t index, uint32_t start)
+{
+	while (LL_I2C_IsActiveFlag_BUSY(I2Cx))
+		if (HAL_GetTick() - start > XFER_TIMEOUT_MS)
+			return 0;
+	LL_I2C_GenerateStartCondition(I2Cx);
+	if (!waitSr1(I2Cx, I2C_SR1_SB, start))
+		return 0;
+	LL_I2C_TransmitData8(I2Cx, address & 0xFE);
+	if (!waitSr1(I2Cx, I2C_SR1_ADDR, start))
+		return 0;
+	LL_I2C_ClearFlag_ADDR(I2Cx);
+	if (!waitSr1(I2Cx, I2C_SR1_TXE, start))
+		return 0;
+	LL_I2C_TransmitData8(I2Cx, (uint8_t)(index >> 8));
+	if (!waitSr1(I2Cx, I2C_SR1_TXE, start))
+		return 0;
+	LL_I2C_TransmitData8(I2Cx, (uint8_t)index);
+	return 1;
+}
+
+VL53L1_Error VL53XferWritePolled(I2C_HandleTypeDef *hi2c, uint8_t address, uint16_t index, const uint8_t *pData, uint16_t count)
+{
+	I2C_TypeDef *I2Cx;
+	uint32_t start = HAL_GetTick();
+	uint16_t i;
+
+	if (hi2c == NULL)
+		return VL53L1_ERROR_INVALID_PARAMS;
+	I2Cx = hi2c->Instance;
+	if (!sendHeader(I2Cx, address, index, start))
+		return abortPolled(I2Cx);
+	for (i = 0; i < count; i++)
+	{
+		if (!waitSr1(I2Cx, I2C_SR1_TXE, start))
+			return abortPolled(I2Cx);
+		LL_I2C_TransmitData8(I2Cx, pData[i]);
+	}
+	if (!waitSr1(I2Cx, I2C_SR1_BTF, start))
+		return abortPolled(I2Cx);
+	LL_I2C_GenerateStopCondition(I2Cx);
+	return VL53L1_ERROR_NONE;
+}
+
+//the F1 receiver needs the ACK/STOP handling of RM0008 26.3.3 for 1, 2 and N>2 bytes,
+//the short windows between clearing ADDR and the next step must not be interrupted
+VL53L1_Error VL53XferReadPolled(I2C_HandleTypeDef *hi2c, uint8_t address, uint16_t index, uint8_t *pData, uint16_t count)
+{
+	I2C_TypeDef *I2Cx;
+	uint32_t start = HAL_GetTick();
+	uint16_t left = count;
+
+	if (hi2c == NULL || count == 0)
+		return VL53L1_ERROR_INVALID_PARAMS;
+	I2Cx = hi2c->Instance;
+	if (!sendHeader(I2Cx, address, index, start) || !waitSr1(I2Cx, I2C_SR1_BTF, start))
+		return abortPolled(I2Cx);
+
+	LL_I2C_GenerateStartCondition(I2Cx);
+	if (!waitSr1(I2Cx, I2C_SR1_SB, start))
+		return abortPolled(I2Cx);
+	LL_I2C_TransmitData8(I2Cx, address | 0x01);
+	if (count == 2)
+		LL_I2C_EnableBitPOS(I2Cx);
+	LL_I2C_AcknowledgeNextData(I2Cx, count > 2 ? LL_I2C_ACK : LL_I2C_NACK);
+	if (!waitSr1(I2Cx, I2C_SR1_ADDR, start))
+		return abortPolled(I2Cx);
+
+	if (count == 1)
+	{
+		__disable_irq();
+		LL_I2C_ClearFlag_ADDR(I2Cx);
+		LL_I2C_GenerateStopCondition(I2Cx);
+		__enable_irq();
+		if (!waitSr1(I2Cx, I2C_SR1_RXNE, start))
+			return abortPolled(I2Cx);
+		pData[0] = LL_I2C_ReceiveData8(I2Cx);
+	}
+	else if (count == 2)
+	{
+		LL_I2C_ClearFlag_ADDR(I2Cx);
+		if (!waitSr1(I2Cx, I2C_SR1_BTF, start))
+			return abortPolled(I2Cx);
+		__disable_irq();
+		LL_I2C_GenerateStopCondition(I2Cx);
+		pData[0] = LL_I2C_ReceiveData8(I2Cx);
+		__enable_irq();
+		pData[1] = LL_I2C_ReceiveData8(I2Cx);
+		LL_I2C_DisableBitPOS(I2Cx);
+	}
+	else
+	{
+		LL_I2C_ClearFlag_ADDR(I2Cx);
+		while (left > 3)
+		{
+			if (!waitSr1(I2Cx, I2C_SR1_RXNE, start))
+				return abortPolled(I2Cx);
+			*pData++ = LL_I2C_ReceiveData8(I2Cx);
+			left--;
+		}
+		//N-2 in DR, N-1 in the shift register
+		if (!waitSr1(I2Cx, I2C_SR1_BTF, start))
+			return abortPolled(I2Cx);
+		LL_I2C_AcknowledgeNextData(I2Cx, LL_I2C_NACK);
+		__disable_irq();
+		*pData++ = LL_I2C_ReceiveData8(I2Cx);
+		if (!waitSr1(I2Cx, I2C_SR1_BTF, start))
+		{
+			__enable_irq();
+			return abortPolled(I2Cx);
+		}
+		LL_I2C_GenerateStopCondition(I2Cx);
+		*pData++ = LL_I2C_ReceiveData8(I2Cx);
+		__enable_irq();
+		if (!waitSr1(I2Cx, I2C_SR1_RXNE, start))
+			return abortPolled(I2Cx);
+		*pData = LL_I2C_ReceiveData8(I2Cx);
+	}
+	LL_I2C_AcknowledgeNextData(I2Cx, LL_I2C_ACK);
+	return VL53L1_ERROR_NONE;
+}
+
+//the HAL has no abort for memory transfers, a re-init drops the DMA and the handle state
+static VL53L1_Error waitDma(I2C_HandleTypeDef *hi2c)
+{
+	uint32_t start = HAL_GetTick();
+
+	while (xferState.dmaBusy)
+	{
+		if (HAL_GetTick() - start > XFER_TIMEOUT_MS)
+		{
+			HAL_I2C_DeInit(hi2c);
+			HAL_I2C_Init(hi2c);
+			xferState.dmaBusy = 0;
+			return VL53L1_ERROR_TIME_OUT;
+		}
+	}
+	return xferState.dmaError ? VL53L1_ERROR_CONTROL_INTERFACE : VL53L1_ERROR_NONE;
+}
+
+VL53L1_Error VL53XferReadDma(I2C_HandleTypeDef *hi2c, uint8_t address, uint16_t index, uint8_t *pData, uint16_t count)
+{
+	if (hi2c == NULL)
+		return VL53L1_ERROR_INVALID_PARAMS;
+	xferState.dmaBusy = 1;
+	xferState.dmaError = 0;
+	if (HAL_I2C_Mem_Read_DMA(hi2c, address, index, I2C_MEMADD_SIZE_16BIT, pData, count) != HAL_OK)
+	{
+		xferState.dmaBusy = 0;
+		return VL53L1_ERROR_CONTROL_INTERFACE;
+	}
+	return waitDma(hi2c);
+}
+
+VL53L1_Error VL53XferWriteDma(I2C_HandleTypeDef *hi2c, uint8_t address, uint16_t index, uint8_t *pData, uint16_t count)
+{
+	if (hi2c == NULL)
+		return VL53L1_ERROR_INVALID_PARAMS;
+	xferState.dmaBusy = 1;
+	xferState.dmaError = 0;
+	if (HAL_I2C_Mem_Write_DMA(hi2c, address, index, I2C_MEMADD_SIZE_16BIT, pData, count) != HAL_OK)
+	{
+		xferState.dmaBusy = 0;
+		return VL53L1_ERROR_CONTROL_INTERFACE;
+	}
+	return waitDma(hi2c);
+}
+
+//from the HAL I2C Mem Rx/Tx complete and error callbacks
+void VL53XferComplete(I2C_HandleTypeDef *hi2c, uint8_t error)
+{
+	(void)hi2c;
+	xferState.dmaError = error;
+	xferState.dmaBusy = 0;
+}
+
+//the F1 DMA receive path needs at least 2 bytes
+VL53L1_Error VL53XferRead(VL53L1_Dev_t* pDev, uint16_t index, uint8_t *pData, uint32_t count)
+{
+	if (count <= xferState.pollMax || count < 2)
+	{
+		xferState.polled++;
+		return VL53XferReadPolled(pDev->I2cHandle, pDev->I2cDevAddr, index, pData, (uint16_t)count);
+	}
+	xferState.dma++;
+	return VL53XferReadDma(pDev->I2cHandle, pDev->I2cDevAddr, index, pData, (uint16_t)count);
+}
+
+VL53L1_Error VL53XferWrite(VL53L1_Dev_t* pDev, uint16_t index, uint8_t *pData, uint32_t count)
+{
+	if (count <= xferState.pollMax || count < 2)
+	{
+		xferState.polled++;
+		return VL53XferWritePolled(pDev->I2cHandle, pDev->I2cDevAddr, index, pData, (uint16_t)count);
+	}
+	xferState.dma++;
+	return VL53XferWriteDma(pDev->I2cHandle, pDev->I2cDevAddr, index, pData, (uint16_t)count);
+}
+
+static uint16_t benchPath(VL53L1_Dev_t* pDev, uint16_t index, uint16_t size, uint8_t dma)
+{
+	uint8_t buf[64];
+	uint32_t startUs, totalUs = 0;
+	VL53L1_Error Status;
+	uint8_t i;
+
+	for (i = 0; i < XFER_BENCH_REPEAT; i++)
+	{
+		startUs = Timebase_Us();
+		if (dma)
+			Status = VL53XferReadDma(pDev->I2cHandle, pDev->I2cDevAddr, index, buf, size);
+		else
+			Status = VL53XferReadPolled(pDev->I2cHandle, pDev->I2cDevAddr, index, buf, size);
+		if (Status != VL53L1_ERROR_NONE)
+			return 0xFFFF;
+		totalUs += Timebase_Us() - startUs;
+	}
+	totalUs /= XFER_BENCH_REPEAT;
+	return totalUs > 0xFFFE ? 0xFFFE : (uint16_t)totalUs;
+}
+
+//reads only, index has to start a block of at least 44 readable bytes (the result block).
+//pollMax ends up below the first size where DMA is faster
+VL53L1_Error VL53XferBench(VL53L1_Dev_t* pDev, uint16_t index, xfer_bench *pBench)
+{
+	uint8_t i, crossed = 0;
+
+	pBench->pollMax = benchSizes[XFER_BENCH_SIZES - 1];
+	for (i = 0; i < XFER_BENCH_SIZES; i++)
+	{
+		pBench->size[i] = benchSizes[i];
+		pBench->pollUs[i] = benchPath(pDev, index, benchSizes[i], 0);
+		pBench->dmaUs[i] = benchSizes[i] < 2 ? 0xFFFF : benchPath(pDev, index, benchSizes[i], 1);
+		if (pBench->pollUs[i] == 0xFFFF && pBench->dmaUs[i] == 0xFFFF)
+			return VL53L1_ERROR_CONTROL_INTERFACE;
+		//a size one path failed on (0xFFFF) says nothing about the crossover
+		if (pBench->pollUs[i] == 0xFFFF || pBench->dmaUs[i] == 0xFFFF)
+			continue;
+		if (!crossed && pBench->dmaUs[i] < pBench->pollUs[i])
+		{
+			crossed = 1;
+			pBench->pollMax = i ? benchSizes[i - 1] : 1;
+		}
+	}
+	xferState.pollMax = pBench->pollMax;
+	return VL53L1_ERROR_NONE;
+}
+
+int VL53XferBenchFormat(char *buf, size_t len, const xfer_bench *pBench)
+{
+	int n, total;
+	uint8_t i;
+
+	total = snprintf(buf, len, "XFB,%u", pBench->pollMax);
+	for (i = 0; i < XFER_BENCH_SIZES && total >= 0 && (size_t)total < len; i++)
+	{
+		n = snprintf(buf + total, len - total, ",%u:%u/%u", pBench->size[i],
+				pBench->pollUs[i], pBench->dmaUs[i]);
+		if (n < 0)
+			return n;
+		total += n;
+	}
+	if (total >= 0 && (size_t)total < len)
+		total += snprintf(buf + total, len - total, "\r\n");
+	return total;
+}
@@ -0,0 +1,68 @@
+/*
+ * vl53l1x_xfer.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: dkupe
+ */
+
+#ifndef VL53L1X_XFER_H_
+#define VL53L1X_XFER_H_
+
+#include "vl53l1x_api.h"
+#include "main.h"
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+//per transfer choice of the I2C path for the platform ReadMulti/WriteMulti/RdByte/WrByte.
+//up to pollMax bytes the transfer is done on the registers with LL calls and busy waits,
+//for the interrupt clear and data ready polls the DMA and interrupt setup costs more than
+//the bytes. longer transfers (result block, calibration data) go through HAL DMA.
+//VL53XferBench() times both paths per size and moves pollMax to the crossover.
+//the platform layer (vl53l1x_platform.c) is not part of this tree and does not call
+//VL53XferRead/VL53XferWrite, so the driver's own transfers do not take this path;
+//the polled reads serve the collision fast path and the bench.
+
+#ifndef XFER_POLL_MAX_DEFAULT
+#define XFER_POLL_MAX_DEFAULT   4
+#endif
+#define XFER_TIMEOUT_MS         10
+#define XFER_BENCH_SIZES        8
+#define XFER_BENCH_REPEAT       16
+
+//the bus runs at the I2C1 clock for both paths, the difference is all setup and wakeups
+typedef struct
+{
+	uint16_t pollMax;              //transfers up to this size use the polled path
+	uint32_t polled;
+	uint32_t dma;
+	volatile uint8_t dmaBusy;
+	volatile uint8_t dmaError;
+}xfer_state;
+
+typedef struct
+{
+	uint16_t size[XFER_BENCH_SIZES];
+	uint16_t pollUs[XFER_BENCH_SIZES];	//mean per read, 0xFFFF = failed
+	uint16_t dmaUs[XFER_BENCH_SIZES];
+	uint16_t pollMax;              //chosen crossover
+}xfer_bench;
+
+extern xfer_state xferState;
+
+VL53L1_Error VL53XferRead(VL53L1_Dev_t* pDev, uint16_t index, uint8_t *pData, uint32_t count);
+VL53L1_Error VL53XferWrite(VL53L1_Dev_t* pDev, uint16_t index, uint8_t *pData, uint32_t count);
+VL53L1_Error VL53XferReadPolled(I2C_HandleTypeDef *hi2c, uint8_t address, uint16_t index, uint8_t *pData, uint16_t count);
+VL53L1_Error VL53XferWritePolled(I2C_HandleTypeDef *hi2c, uint8_t address, uint16_t index, const uint8_t *pData, uint16_t count);
+VL53L1_Error VL53XferReadDma(I2C_HandleTypeDef *hi2c, uint8_t address, uint16_t index, uint8_t *pData, uint16_t count);
+VL53L1_Error VL53XferWriteDma(I2C_HandleTypeDef *hi2c, uint8_t address, uint16_t index, uint8_t *pData, uint16_t count);
+void VL53XferComplete(I2C_HandleTypeDef *hi2c, uint8_t error);
+VL53L1_Error VL53XferBench(VL53L1_Dev_t* pDev, uint16_t index, xfer_bench *pBench);
+int VL53XferBenchFormat(char *buf, size_t len, const xfer_bench *pBench);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VL53L1X_XFER_H_ */
@@ -0,0 +1,34 @@
+/*
+ * check.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: dkupe
+ */
+
+#ifndef CHECK_H_
+#define CHECK_H_
+
+#include <stdio.h>
+
+//minimal host test helpers: CHECK() reports and counts a failure, CHECK_RESULT() prints
+//the verdict and gives the exit code
+
+static int checkFailures;
+
+#define CHECK(cond, ...) \
+	do { \
+		if (!(cond)) \
+		{ \
+			if (checkFailures++ < 20) \
+			{ \
+				printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+				printf(__VA_ARGS__); \
+				printf("\n"); \
+			} \
+		} \
+	} while (0)
+
+#define CHECK_RESULT(name) \
+	(printf("%s: %s (%d failures)\n", (name), checkFailures ? "FAIL" : "PASS", checkFailures), checkFailures != 0)
+
+#endif /* CHECK_H_ */
@@ -0,0 +1,195 @@
+/*
+ * i2c_model.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: dkupe
+ */
+
+#ifndef I2C_MODEL_H_
+#define I2C_MODEL_H_
+
+#include <stdint.h>
+
+//bit level model of MODEL_SLAVES VL53L1 like slaves (16 bit index, auto increment) on
+//open drain lines, shared by the host tests of the software I2C engines. every BSRR
+//write goes through modelBsrr(), modelIdr() gives the port input. SCL is MODEL_SCL,
+//each slave has its own SDA bit (sdaShift), several slaves may share one.
+
+#ifndef MODEL_SCL
+#define MODEL_SCL    (1u << 5)
+#endif
+
+enum { SLAVE_IDLE, SLAVE_ADDR, SLAVE_INDEX_HI, SLAVE_INDEX_LO, SLAVE_WRITE, SLAVE_READ };
+enum { PHASE_BITS, PHASE_ACK, PHASE_TX, PHASE_MASTER_ACK };
+
+typedef struct
+{
+	uint8_t  address;
+	uint8_t  sdaShift;
+	uint8_t  state;
+	uint8_t  phase;
+	uint8_t  bits;
+	uint8_t  shift;
+	uint8_t  drive;            //pulling SDA low
+	uint8_t  next;             //state after the ACK
+	uint8_t  current;          //byte being sent
+	uint8_t  masterAck;
+	uint16_t index;
+	uint8_t  mem[65536];
+}model_slave;
+
+static model_slave slaves[MODEL_SLAVES];
+static uint32_t odr = 0xFFFF;
+
+static uint8_t sclLine(void)
+{
+	return (odr & MODEL_SCL) != 0;
+}
+
+static uint8_t sdaLine(const model_slave *pSlave)
+{
+	return (odr & (1u << pSlave->sdaShift)) && !pSlave->drive;
+}
+
+static uint32_t modelIdr(void)
+{
+	uint32_t value = odr & MODEL_SCL;
+	uint8_t k;
+
+	for (k = 0; k < MODEL_SLAVES; k++)
+		value |= (uint32_t)sdaLine(&slaves[k]) << slaves[k].sdaShift;
+	return value;
+}
+
+static void sendByte(model_slave *pSlave)
+{
+	pSlave->current = pSlave->mem[pSlave->index++];
+	pSlave->bits = 0;
+	pSlave->drive = !(pSlave->current & 0x80);
+	pSlave->phase = PHASE_TX;
+}
+
+//a whole byte came in, decide on the ACK and what follows it
+static void received(model_slave *pSlave)
+{
+	uint8_t value = pSlave->shift;
+
+	pSlave->bits = 0;
+	pSlave->shift = 0;
+	switch (pSlave->state)
+	{
+	case SLAVE_ADDR:
+		if ((value >> 1) != (pSlave->address >> 1))
+		{
+			pSlave->state = SLAVE_IDLE;
+			return;
+		}
+		pSlave->next = (value & 1) ? SLAVE_READ : SLAVE_INDEX_HI;
+		break;
+	case SLAVE_INDEX_HI:
+		pSlave->index = (uint16_t)(value << 8);
+		pSlave->next = SLAVE_INDEX_LO;
+		break;
+	case SLAVE_INDEX_LO:
+		pSlave->index |= value;
+		pSlave->next = SLAVE_WRITE;
+		break;
+	default:
+		pSlave->mem[pSlave->index++] = value;
+		pSlave->next = SLAVE_WRITE;
+		break;
+	}
+	pSlave->phase = PHASE_ACK;
+	pSlave->drive = 1;
+}
+
+static void sclFalling(model_slave *pSlave)
+{
+	if (pSlave->phase == PHASE_BITS && pSlave->bits == 8)
+		received(pSlave);
+	else if (pSlave->phase == PHASE_ACK)
+	{
+		pSlave->drive = 0;
+		pSlave->state = pSlave->next;
+		if (pSlave->state == SLAVE_READ)
+			sendByte(pSlave);
+		else
+			pSlave->phase = PHASE_BITS;
+	}
+	else if (pSlave->phase == PHASE_TX)
+	{
+		if (++pSlave->bits == 8)
+		{
+			pSlave->drive = 0;
+			pSlave->phase = PHASE_MASTER_ACK;
+		}
+		else
+			pSlave->drive = !((pSlave->current << pSlave->bits) & 0x80);
+	}
+	else if (pSlave->phase == PHASE_MASTER_ACK)
+	{
+		if (pSlave->masterAck)
+			sendByte(pSlave);
+		else
+		{
+			pSlave->state = SLAVE_IDLE;
+			pSlave->drive = 0;
+		}
+	}
+}
+
+static void modelBsrr(uint32_t value)
+{
+	uint8_t oldScl = sclLine(), scl;
+	uint8_t oldSda[MODEL_SLAVES];
+	uint8_t k;
+
+	for (k = 0; k < MODEL_SLAVES; k++)
+		oldSda[k] = sdaLine(&slaves[k]);
+	odr |= value & 0xFFFF;
+	odr &= ~(value >> 16);
+	scl = sclLine();
+
+	for (k = 0; k < MODEL_SLAVES; k++)
+	{
+		model_slave *pSlave = &slaves[k];
+		uint8_t sda = sdaLine(pSlave);
+
+		if (oldScl && scl && oldSda[k] && !sda)
+		{
+			//(repeated) start
+			pSlave->state = SLAVE_ADDR;
+			pSlave->phase = PHASE_BITS;
+			pSlave->bits = 0;
+			pSlave->shift = 0;
+			pSlave->drive = 0;
+		}
+		else if (oldScl && scl && !oldSda[k] && sda)
+		{
+			//stop
+			pSlave->state = SLAVE_IDLE;
+			pSlave->drive = 0;
+		}
+		else if (pSlave->state == SLAVE_IDLE)
+			continue;
+		else if (!oldScl && scl)
+		{
+			if (pSlave->phase == PHASE_BITS)
+			{
+				pSlave->shift = (uint8_t)(pSlave->shift << 1 | sda);
+				pSlave->bits++;
+			}
+			else if (pSlave->phase == PHASE_MASTER_ACK)
+				pSlave->masterAck = !sda;
+		}
+		else if (oldScl && !scl)
+			sclFalling(pSlave);
+	}
+}
+
+static uint8_t pattern(uint16_t index, uint8_t k)
+{
+	return (uint8_t)(index * 7 + k * 91);
+}
+
+#endif /* I2C_MODEL_H_ */
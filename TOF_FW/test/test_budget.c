@@ -0,0 +1,122 @@
+/*
+ * test_budget.c
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: dkupe
+ */
+
+#include "vl53l1x_budget.h"
+#include "check.h"
+
+//the budget API is stubbed with a model that derives every timeout field from the
+//budget and the VCSEL periods. a cached budget has to leave the driver state exactly as
+//the API does, without calling it; another preset, other VCSEL periods or an uncached
+//budget have to go to the API. building the cache must not change the device state.
+
+#define MODEL_BUDGET_MIN  10000		//the model rejects shorter budgets like a distance mode does
+#define MODEL_PRESET      2
+
+static VL53L1_Dev_t dev;
+static uint32_t apiSets;
+
+static uint8_t hi(uint32_t value)
+{
+	return (uint8_t)((value >> 8) & 0x0F);
+}
+
+VL53L1_Error VL53L1_SetMeasurementTimingBudgetMicroSeconds(VL53L1_DEV Dev, uint32_t budgetUs)
+{
+	VL53L1_LLDriverData_t *pLL = VL53L1DevStructGetLLDriverHandle(Dev);
+	VL53L1_timing_config_t *pCfg = &pLL->tim_cfg;
+	uint32_t a = budgetUs / (pCfg->range_config__vcsel_period_a + 1);
+	uint32_t b = budgetUs / (pCfg->range_config__vcsel_period_b + 3);
+
+	apiSets++;
+	if (budgetUs < MODEL_BUDGET_MIN)
+		return VL53L1_ERROR_INVALID_PARAMS;
+	pLL->phasecal_config_timeout_us = budgetUs / 40;
+	pLL->mm_config_timeout_us = budgetUs / 20;
+	pLL->range_config_timeout_us = budgetUs / 2;
+	pLL->gen_cfg.phasecal_config__timeout_macrop = (uint8_t)(budgetUs / 1000);
+	pCfg->mm_config__timeout_macrop_a_hi = hi(a / 7);
+	pCfg->mm_config__timeout_macrop_a_lo = (uint8_t)(a / 7);
+	pCfg->mm_config__timeout_macrop_b_hi = hi(b / 7);
+	pCfg->mm_config__timeout_macrop_b_lo = (uint8_t)(b / 7);
+	pCfg->range_config__timeout_macrop_a_hi = hi(a);
+	pCfg->range_config__timeout_macrop_a_lo = (uint8_t)a;
+	pCfg->range_config__timeout_macrop_b_hi = hi(b);
+	pCfg->range_config__timeout_macrop_b_lo = (uint8_t)b;
+	VL53L1_SETPARAMETERFIELD(Dev, MeasurementTimingBudgetMicroSeconds, budgetUs);
+	return VL53L1_ERROR_NONE;
+}
+
+VL53L1_Error VL53L1_GetMeasurementTimingBudgetMicroSeconds(VL53L1_DEV Dev, uint32_t *pBudgetUs)
+{
+	VL53L1_GETPARAMETERFIELD(Dev, MeasurementTimingBudgetMicroSeconds, *pBudgetUs);
+	return VL53L1_ERROR_NONE;
+}
+
+static void setVcsel(uint8_t a, uint8_t b)
+{
+	dev.Data.LLData.tim_cfg.range_config__vcsel_period_a = a;
+	dev.Data.LLData.tim_cfg.range_config__vcsel_period_b = b;
+}
+
+//a cache hit has to leave the same driver state as the API
+static void checkHit(budget_cache *pCache, uint32_t budgetUs)
+{
+	VL53L1_Dev_t expect;
+	uint32_t sets = apiSets, hits = pCache->hits;
+
+	expect = dev;
+	CHECK(VL53L1_SetMeasurementTimingBudgetMicroSeconds(&expect, budgetUs) == VL53L1_ERROR_NONE, "model");
+	apiSets = sets;
+	CHECK(VL53BudgetSet(&dev, pCache, MODEL_PRESET, budgetUs) == VL53L1_ERROR_NONE, "set %lu", (unsigned long)budgetUs);
+	CHECK(apiSets == sets && pCache->hits == hits + 1, "%lu not served from the cache", (unsigned long)budgetUs);
+	CHECK(memcmp(&expect, &dev, sizeof(dev)) == 0, "%lu: driver state differs from the API", (unsigned long)budgetUs);
+}
+
+static void checkMiss(budget_cache *pCache, uint8_t preset, uint32_t budgetUs, const char *what)
+{
+	uint32_t sets = apiSets, misses = pCache->misses;
+
+	VL53BudgetSet(&dev, pCache, preset, budgetUs);
+	CHECK(apiSets == sets + 1 && pCache->misses == misses + 1, "%s: not passed to the API", what);
+}
+
+int main(void)
+{
+	static const uint32_t budgets[] = {5000, 20000, 33000, 200000};
+	budget_cache cache;
+	VL53L1_Dev_t before;
+	uint8_t i;
+
+	setVcsel(15, 13);
+	VL53L1_SetMeasurementTimingBudgetMicroSeconds(&dev, 50000);
+	before = dev;
+	CHECK(VL53BudgetCacheBuild(&dev, &cache, MODEL_PRESET, budgets, sizeof(budgets) / sizeof(budgets[0])) ==
+			VL53L1_ERROR_NONE, "build");
+	CHECK(memcmp(&before, &dev, sizeof(dev)) == 0, "build changed the device state");
+	CHECK(cache.count == 3, "%u entries, the rejected budget has to be skipped", cache.count);
+	CHECK(cache.preset == MODEL_PRESET && cache.vcselA == 15 && cache.vcselB == 13, "cache key");
+
+	for (i = 1; i < sizeof(budgets) / sizeof(budgets[0]); i++)
+		checkHit(&cache, budgets[i]);
+	checkHit(&cache, 20000);
+	checkMiss(&cache, MODEL_PRESET, 50000, "uncached budget");
+	checkMiss(&cache, MODEL_PRESET + 1, 33000, "other preset");
+	checkMiss(&cache, BUDGET_PRESET_NONE, 33000, "no preset");
+	setVcsel(11, 9);
+	checkMiss(&cache, MODEL_PRESET, 33000, "other VCSEL periods");
+
+	//rebuilt for the new periods it serves again
+	CHECK(VL53BudgetCacheBuild(&dev, &cache, MODEL_PRESET, budgets, sizeof(budgets) / sizeof(budgets[0])) ==
+			VL53L1_ERROR_NONE, "rebuild");
+	checkHit(&cache, 33000);
+
+	//an empty cache matches nothing
+	memset(&cache, 0, sizeof(cache));
+	cache.preset = BUDGET_PRESET_NONE;
+	checkMiss(&cache, MODEL_PRESET, 33000, "empty cache");
+	return CHECK_RESULT("test_budget");
+}
@@ -0,0 +1,98 @@
+/*
+ * test_filter.c
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: dkupe
+ */
+
+#include "vl53l1x_filter.h"
+#include "check.h"
+
+//replays a range trace through VL53FilterUpdate() in every filter mode:
+//rejected statuses never produce FILTER_OK, and once settled the output stays within
+//tolerance of the truth column, spikes and status failures included.
+
+#define TRACE_MAX     512
+#define SETTLE_FRAMES 8		//frames after start or a truth step that are not checked
+
+typedef struct
+{
+	int16_t truth;
+	int16_t range;
+	uint8_t status;
+	uint8_t sigma;
+}trace_frame;
+
+static trace_frame trace[TRACE_MAX];
+
+static int loadTrace(const char *path)
+{
+	FILE *f = fopen(path, "r");
+	char line[128];
+	int n = 0;
+
+	if (f == NULL)
+		return 0;
+	while (n < TRACE_MAX && fgets(line, sizeof(line), f))
+	{
+		int truth, range, status, sigma;
+
+		if (line[0] == '#' || sscanf(line, "%d,%d,%d,%d", &truth, &range, &status, &sigma) != 4)
+			continue;
+		trace[n].truth = (int16_t)truth;
+		trace[n].range = (int16_t)range;
+		trace[n].status = (uint8_t)status;
+		trace[n].sigma = (uint8_t)sigma;
+		n++;
+	}
+	fclose(f);
+	return n;
+}
+
+static void replay(int frames, uint8_t mode, int32_t tolMm)
+{
+	filter_config config = filterDefaultConfig;
+	filter_state filter;
+	int i, settle = SETTLE_FRAMES;
+
+	config.mode = mode;
+	VL53FilterInit(&filter, &config);
+	for (i = 0; i < frames; i++)
+	{
+		VL53L1_RangingMeasurementData_t data;
+		int32_t out = -1;
+		uint8_t result;
+
+		memset(&data, 0, sizeof(data));
+		data.RangeMilliMeter = trace[i].range;
+		data.RangeStatus = trace[i].status;
+		data.SigmaMilliMeter = (FixPoint1616_t)trace[i].sigma << 16;
+		result = VL53FilterUpdate(&filter, &data, &out);
+
+		if (i > 0 && trace[i].truth - trace[i - 1].truth > 100)
+			settle = SETTLE_FRAMES;
+		if (i > 0 && trace[i - 1].truth - trace[i].truth > 100)
+			settle = SETTLE_FRAMES;
+		if (!(config.statusMask & FILTER_STATUS_BIT(trace[i].status)))
+			CHECK(result != FILTER_OK, "mode %u frame %d: status %u accepted", mode, i, trace[i].status);
+		if (settle)
+		{
+			settle--;
+			continue;
+		}
+		CHECK(result != FILTER_NO_DATA, "mode %u frame %d: no output", mode, i);
+		CHECK(out - trace[i].truth <= tolMm && trace[i].truth - out <= tolMm,
+				"mode %u frame %d: out %ld truth %d", mode, i, (long)out, trace[i].truth);
+	}
+}
+
+int main(int argc, char **argv)
+{
+	int frames = loadTrace(argc > 1 ? argv[1] : "data/filter_trace.csv");
+
+	CHECK(frames > 0, "trace not loaded");
+	replay(frames, FILTER_MEDIAN, 25);
+	replay(frames, FILTER_KALMAN, 40);
+	replay(frames, FILTER_MEDIAN_KALMAN, 25);
+	return CHECK_RESULT("test_filter");
+}
@@ -0,0 +1,61 @@
+/*
+ * test_fixpoint.c
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: dkupe
+ */
+
+#include "vl53l1x_fixpoint.h"
+#include "vl53l1x_preset.h"
+#include "check.h"
+
+//the helpers against plain integer arithmetic, and the constant macros the preset table
+//uses against the runtime conversions they stand for
+
+static void checkMul(void)
+{
+	uint32_t a, b;
+	uint8_t frac;
+
+	for (frac = 0; frac <= 15; frac++)
+		for (a = 0; a <= 0xFFFF; a += 257)
+			for (b = 0; b <= 0xFFFF; b += 251)
+			{
+				uint32_t expect = (a * b + (frac ? 1u << (frac - 1) : 0)) >> frac;
+
+				if (expect > 0xFFFF)
+					expect = 0xFFFF;
+				CHECK(fix16Mul((uint16_t)a, (uint16_t)b, frac) == expect,
+						"fix16Mul(%lu,%lu,%u)", (unsigned long)a, (unsigned long)b, frac);
+			}
+}
+
+static void checkRegisters(void)
+{
+	uint32_t reg;
+
+	//register -> 16.16 -> register is exact for every encoding
+	for (reg = 0; reg <= 0xFFFF; reg++)
+	{
+		CHECK(PRESET_RATE_REG(fix97To1616((FixPoint97_t)reg)) == reg, "rate %lu", (unsigned long)reg);
+		CHECK(PRESET_SIGMA_REG(fixRescale(reg, FIX142_FRAC_BITS, FIX1616_FRAC_BITS)) == reg,
+				"sigma %lu", (unsigned long)reg);
+	}
+	//rounding of the constant macro matches fixRescale()
+	for (reg = 0; reg < 0x01000000; reg += 4099)
+	{
+		CHECK(FIX_RESCALE_CONST(reg, FIX1616_FRAC_BITS, FIX97_FRAC_BITS) ==
+				fixRescale(reg, FIX1616_FRAC_BITS, FIX97_FRAC_BITS), "97 %lu", (unsigned long)reg);
+		CHECK(FIX_RESCALE_CONST(reg, FIX1616_FRAC_BITS, FIX142_FRAC_BITS) ==
+				fixRescale(reg, FIX1616_FRAC_BITS, FIX142_FRAC_BITS), "142 %lu", (unsigned long)reg);
+	}
+	CHECK(PRESET_RATE_REG(FIX1616_CONST(0, 250)) == 32, "0.25 Mcps");
+	CHECK(PRESET_SIGMA_REG(FIX1616_CONST(15, 0)) == 60, "15 mm");
+}
+
+int main(void)
+{
+	checkMul();
+	checkRegisters();
+	return CHECK_RESULT("test_fixpoint");
+}
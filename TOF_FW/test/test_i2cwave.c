@@ -0,0 +1,146 @@
+/*
+ * test_i2cwave.c
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: dkupe
+ */
+
+#include "main.h"
+#include "check.h"
+
+//runs the symbol encoder and decoder of the wave engine against the slave model: the
+//test plays both DMA channels, one out word per tick into the model port and one IDR
+//sample per tick, the sample ahead of the word like CC3 at half the first period is
+//ahead of the first update, and raises the half/complete callbacks at the chunk ends.
+//reads and writes of every length have to round trip, a missing slave has to NACK.
+
+#undef __WFI
+#define __WFI()
+#include "vl53l1x_i2cwave.c"
+
+#define MODEL_SLAVES 1
+#define MODEL_SDA    (1u << 0)
+#include "i2c_model.h"
+
+static uint32_t ticks;
+
+uint32_t HAL_GetTick(void)
+{
+	return ticks;
+}
+
+void HAL_GPIO_Init(GPIO_TypeDef *GPIOx, GPIO_InitTypeDef *GPIO_Init)
+{
+}
+
+//the transfer is played by runDma()
+HAL_StatusTypeDef HAL_DMA_Start_IT(DMA_HandleTypeDef *hdma, uint32_t SrcAddress, uint32_t DstAddress, uint32_t DataLength)
+{
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_DMA_Abort(DMA_HandleTypeDef *hdma)
+{
+	return HAL_OK;
+}
+
+static void runDma(wave_bus *pBus)
+{
+	uint32_t t;
+
+	for (t = 0; pBus->busy && t < 4 * WAVE_SYMS_MAX * WAVE_TICKS_PER_SYM; t++)
+	{
+		uint16_t pos = t % (2 * WAVE_CHUNK_TICKS);
+
+		pBus->in[pos] = (uint16_t)modelIdr();
+		if (pos == WAVE_CHUNK_TICKS - 1)
+			pBus->hdmaIn->XferHalfCpltCallback(pBus->hdmaIn);
+		else if (pos == 2 * WAVE_CHUNK_TICKS - 1)
+			pBus->hdmaIn->XferCpltCallback(pBus->hdmaIn);
+		if (!pBus->busy)
+			break;
+		modelBsrr(pBus->out[pos]);
+		if (pos == WAVE_CHUNK_TICKS - 1)
+			pBus->hdmaOut->XferHalfCpltCallback(pBus->hdmaOut);
+		else if (pos == 2 * WAVE_CHUNK_TICKS - 1)
+			pBus->hdmaOut->XferCpltCallback(pBus->hdmaOut);
+	}
+}
+
+static VL53L1_Error waveRead(wave_bus *pBus, uint8_t address, uint16_t index, uint8_t *pData, uint16_t len)
+{
+	VL53L1_Error Status = VL53WaveStartRead(pBus, address, index, len);
+
+	if (Status != VL53L1_ERROR_NONE)
+		return Status;
+	CHECK(VL53WaveResult(pBus, pData, len) == VL53L1_ERROR_TIME_OUT, "result while busy");
+	CHECK(VL53WaveStartRead(pBus, address, index, len) == VL53L1_ERROR_INVALID_PARAMS, "start while busy");
+	runDma(pBus);
+	CHECK(!pBus->busy, "read %04x/%u never finished", index, len);
+	return VL53WaveResult(pBus, pData, len);
+}
+
+static VL53L1_Error waveWrite(wave_bus *pBus, uint8_t address, uint16_t index, const uint8_t *pData, uint16_t len)
+{
+	VL53L1_Error Status = VL53WaveStartWrite(pBus, address, index, pData, len);
+
+	if (Status != VL53L1_ERROR_NONE)
+		return Status;
+	runDma(pBus);
+	CHECK(!pBus->busy, "write %04x/%u never finished", index, len);
+	return VL53WaveResult(pBus, NULL, 0);
+}
+
+int main(void)
+{
+	static wave_bus bus;
+	TIM_TypeDef timRegs;
+	TIM_HandleTypeDef htim;
+	DMA_HandleTypeDef hdmaOut, hdmaIn;
+	GPIO_TypeDef port;
+	uint8_t buf[WAVE_BYTES_MAX], data[WAVE_BYTES_MAX];
+	uint32_t i;
+	uint16_t len;
+
+	memset(&timRegs, 0, sizeof(timRegs));
+	memset(&htim, 0, sizeof(htim));
+	timRegs.ARR = 44;
+	htim.Instance = &timRegs;
+	slaves[0].address = 0x52;
+	slaves[0].sdaShift = 0;
+	for (i = 0; i < 65536; i++)
+		slaves[0].mem[i] = pattern((uint16_t)i, 0);
+	VL53WaveInit(&bus, &htim, &hdmaOut, &hdmaIn, &port, MODEL_SCL, MODEL_SDA);
+
+	CHECK(VL53WaveStartRead(&bus, 0x52, 0, 0) == VL53L1_ERROR_INVALID_PARAMS, "empty read accepted");
+	CHECK(VL53WaveStartRead(&bus, 0x52, 0, WAVE_BYTES_MAX + 1) == VL53L1_ERROR_INVALID_PARAMS, "long read accepted");
+	CHECK(VL53WaveStartWrite(&bus, 0x52, 0, data, WAVE_BYTES_MAX + 1) == VL53L1_ERROR_INVALID_PARAMS,
+			"long write accepted");
+
+	//every length, the program ends anywhere in a chunk
+	for (len = 1; len <= WAVE_BYTES_MAX; len++)
+	{
+		uint16_t index = (uint16_t)(0x0100 + len * 67);
+
+		memset(buf, 0, sizeof(buf));
+		CHECK(waveRead(&bus, 0x52, index, buf, len) == VL53L1_ERROR_NONE, "read %u failed", len);
+		for (i = 0; i < len; i++)
+			CHECK(buf[i] == pattern((uint16_t)(index + i), 0), "read %u byte %lu: %02x", len,
+					(unsigned long)i, buf[i]);
+
+		for (i = 0; i < len; i++)
+			data[i] = (uint8_t)(len * 13 + i * 29);
+		CHECK(waveWrite(&bus, 0x52, 0x8000, data, len) == VL53L1_ERROR_NONE, "write %u failed", len);
+		CHECK(memcmp(&slaves[0].mem[0x8000], data, len) == 0, "write %u not in the slave", len);
+		CHECK(waveRead(&bus, 0x52, 0x8000, buf, len) == VL53L1_ERROR_NONE && memcmp(buf, data, len) == 0,
+				"write %u does not read back", len);
+	}
+
+	//nobody at 0x54
+	CHECK(waveRead(&bus, 0x54, 0x0010, buf, 2) == VL53L1_ERROR_CONTROL_INTERFACE, "read NACK missed");
+	CHECK(waveWrite(&bus, 0x54, 0x0010, data, 2) == VL53L1_ERROR_CONTROL_INTERFACE, "write NACK missed");
+	//and the bus is still usable
+	CHECK(waveRead(&bus, 0x52, 0x0089, buf, 3) == VL53L1_ERROR_NONE && buf[2] == pattern(0x8B, 0),
+			"read after NACK");
+	return CHECK_RESULT("test_i2cwave");
+}
@@ -0,0 +1,78 @@
+/*
+ * test_lockstep.c
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: dkupe
+ */
+
+#include "main.h"
+#include "check.h"
+
+//runs the lockstep engine against a model of the port: every BSRR write moves the open
+//drain lines, three model slaves watch SCL and their own SDA bit and answer like a
+//VL53L1 (16 bit index, auto increment). lanes 0 and 1 sit at the shared address, lane 2
+//at another one and has to NACK and read 0xFF while the other two get their own bytes.
+
+static void modelBsrr(uint32_t value);
+static uint32_t modelIdr(void);
+
+#define LOCKSTEP_BSRR(port, value)  modelBsrr(value)
+#define LOCKSTEP_IDR(port)          modelIdr()
+#include "vl53l1x_lockstep.c"
+
+uint32_t SystemCoreClock = 72000000;
+
+//the pins were set up by the model already
+void HAL_GPIO_Init(GPIO_TypeDef *GPIOx, GPIO_InitTypeDef *GPIO_Init)
+{
+}
+
+#define MODEL_SLAVES 3
+#define MODEL_LEN    5
+#include "i2c_model.h"
+
+int main(void)
+{
+	static const uint8_t shifts[MODEL_SLAVES] = {0, 1, 3};
+	static const uint8_t write[2] = {0xA5, 0x3C};
+	lockstep_bus bus;
+	GPIO_TypeDef port;
+	uint8_t buf[MODEL_SLAVES * MODEL_LEN];
+	uint16_t nack;
+	uint32_t i;
+	uint8_t k;
+
+	for (k = 0; k < MODEL_SLAVES; k++)
+	{
+		slaves[k].address = k == 2 ? 0x54 : 0x52;
+		slaves[k].sdaShift = shifts[k];
+		for (i = 0; i < 65536; i++)
+			slaves[k].mem[i] = pattern((uint16_t)i, k);
+	}
+
+	CHECK(VL53LockstepInit(&bus, &port, MODEL_SCL, MODEL_SCL | 0x01, 400) == 0, "SCL inside the SDA mask accepted");
+	CHECK(VL53LockstepInit(&bus, &port, MODEL_SCL, 0x0B, 400) == MODEL_SLAVES, "lanes %u", bus.lanes);
+
+	nack = VL53LockstepRead(&bus, 0x52, 0x0089, buf, MODEL_LEN);
+	CHECK(nack == 1u << 2, "read nack %x", nack);
+	for (k = 0; k < MODEL_SLAVES; k++)
+		for (i = 0; i < MODEL_LEN; i++)
+		{
+			uint8_t expect = k == 2 ? 0xFF : pattern((uint16_t)(0x89 + i), k);
+
+			CHECK(buf[k * MODEL_LEN + i] == expect, "lane %u byte %lu: %02x, expected %02x", k,
+					(unsigned long)i, buf[k * MODEL_LEN + i], expect);
+		}
+
+	nack = VL53LockstepWrite(&bus, 0x52, 0x0086, write, sizeof(write));
+	CHECK(nack == 1u << 2, "write nack %x", nack);
+	for (k = 0; k < 2; k++)
+		CHECK(slaves[k].mem[0x86] == 0xA5 && slaves[k].mem[0x87] == 0x3C, "lane %u not written", k);
+	CHECK(slaves[2].mem[0x86] == pattern(0x86, 2), "lane 2 written at the wrong address");
+
+	//the write left the bus idle for the next transfer
+	nack = VL53LockstepRead(&bus, 0x52, 0x0086, buf, 2);
+	CHECK(nack == 1u << 2 && buf[0] == 0xA5 && buf[1] == 0x3C && buf[2] == 0xA5 && buf[3] == 0x3C,
+			"read back %02x %02x %02x %02x", buf[0], buf[1], buf[2], buf[3]);
+	return CHECK_RESULT("test_lockstep");
+}
@@ -0,0 +1,89 @@
+/*
+ * test_roi.c
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: dkupe
+ */
+
+#include "vl53l1x_roi.h"
+#include "check.h"
+
+//exhaustive encode/decode round trip: every optical centre offset the LUT is built for,
+//every ROI size and every logical centre whose shifted ROI fits on the array has to
+//come back unchanged. the clamped centres have to encode to a ROI that is on the array.
+
+#define ROI_OFFSET_MAX 3
+
+static FixPoint1616_t stubCentreX, stubCentreY;
+
+//the optical centre comes from the NVM copy in the driver, stubbed for the host
+VL53L1_Error VL53L1_GetOpticalCenter(VL53L1_DEV Dev, FixPoint1616_t *pOpticalCenterX,
+		FixPoint1616_t *pOpticalCenterY)
+{
+	*pOpticalCenterX = stubCentreX;
+	*pOpticalCenterY = stubCentreY;
+	return VL53L1_ERROR_NONE;
+}
+
+static uint8_t fits(int px, int py, int w, int h)
+{
+	return px >= w / 2 && px <= ROI_GRID - 1 - (w - 1) / 2 &&
+			py >= h / 2 && py <= ROI_GRID - 1 - (h - 1) / 2;
+}
+
+static void roundTrip(const roi_lut *pLut, unsigned long *pChecked)
+{
+	int x, y, w, h;
+
+	for (w = 1; w <= ROI_GRID; w++)
+		for (h = 1; h <= ROI_GRID; h++)
+			for (x = 0; x < ROI_GRID; x++)
+				for (y = 0; y < ROI_GRID; y++)
+				{
+					roi_code code = VL53RoiEncode(pLut, x, y, w, h);
+					uint8_t X = 0xFF, Y = 0xFF, W = 0, H = 0;
+					uint8_t onGrid = VL53RoiDecode(pLut, code, &X, &Y, &W, &H);
+
+					CHECK(W == w && H == h, "d%d,%d %dx%d: size %ux%u", pLut->dx, pLut->dy, w, h, W, H);
+					if (!fits(x + pLut->dx, y + pLut->dy, w, h))
+					{
+						//pulled in: the decoded centre, shifted, has to fit
+						CHECK(onGrid && fits(X + pLut->dx, Y + pLut->dy, w, h),
+								"d%d,%d %dx%d at %d,%d: clamped off the array", pLut->dx, pLut->dy, w, h, x, y);
+						continue;
+					}
+					CHECK(onGrid && X == x && Y == y, "d%d,%d %dx%d at %d,%d: decoded %u,%u",
+							pLut->dx, pLut->dy, w, h, x, y, X, Y);
+					(*pChecked)++;
+				}
+}
+
+int main(void)
+{
+	static roi_lut lut;
+	unsigned long checked = 0;
+	roi_code code;
+	int dx, dy;
+
+	for (dx = -ROI_OFFSET_MAX; dx <= ROI_OFFSET_MAX; dx++)
+		for (dy = -ROI_OFFSET_MAX; dy <= ROI_OFFSET_MAX; dy++)
+		{
+			VL53RoiLutBuild(&lut, dx, dy);
+			roundTrip(&lut, &checked);
+		}
+	CHECK(checked > 0, "nothing checked");
+
+	//nominal part, full array: the driver's default centre SPAD 199, size 0xFF
+	VL53RoiLutBuild(&lut, 0, 0);
+	code = VL53RoiEncode(&lut, ROI_NOMINAL_CENTRE, ROI_NOMINAL_CENTRE, 16, 16);
+	CHECK(code.centreSpad == 199 && code.xySize == 0xFF, "full array %u %02x", code.centreSpad, code.xySize);
+
+	//the offset is the optical centre rounded to the nearest SPAD
+	stubCentreX = (FixPoint1616_t)(9 << 16) | 0x4000;
+	stubCentreY = (FixPoint1616_t)(5 << 16) | 0xC000;
+	CHECK(VL53RoiLutInit(NULL, &lut) == VL53L1_ERROR_NONE && lut.dx == 1 && lut.dy == -2,
+			"LutInit offset %d,%d", lut.dx, lut.dy);
+
+	printf("%lu round trips\n", checked);
+	return CHECK_RESULT("test_roi");
+}
@@ -0,0 +1,132 @@
+/*
+ * test_sync.c
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: dkupe
+ */
+
+#include "vl53l1x_sync.h"
+#include "check.h"
+
+//closed loop model of VL53SyncFrame(): every sensor counts its inter measurement
+//register on an oscillator that is off by up to 5%, a new register value takes effect
+//with the period after the one already running, and the reported ready time carries up
+//to 20us of readout jitter. the run starts shortly before the 32 bit us count wraps and
+//every sensor has to lock within 50us of its slot and stay there.
+
+#define MODEL_SENSORS   3
+#define MODEL_PERIOD_MS 50
+#define MODEL_SLOT_US   2000
+#define MODEL_LOCK_US   50
+#define MODEL_JITTER_US 20
+#define MODEL_FRAMES    400		//per sensor, 20s
+#define MODEL_SETTLE    60		//frames per sensor before the lock is checked
+
+typedef struct
+{
+	int32_t  oscPpm;           //oscillator error, + = slow, longer periods
+	uint32_t startUs;          //first frame after the epoch
+	uint64_t nextNs;
+	uint32_t reg;              //register value of the period running now
+	uint8_t  stream;
+	uint32_t frames;
+}model_sensor;
+
+static VL53L1_Dev_t dev[MODEL_SENSORS];
+static model_sensor model[MODEL_SENSORS];
+static uint64_t nowNs;
+static uint32_t writes;
+
+//starts 2s before the wrap
+#define MODEL_T0_US 0xFFE17B80u
+
+uint32_t Timebase_Us(void)
+{
+	return (uint32_t)(MODEL_T0_US + nowNs / 1000);
+}
+
+//the driver copy was updated by the caller, the device takes it over at the next period
+VL53L1_Error VL53L1_WrDWord(VL53L1_DEV Dev, uint16_t index, uint32_t data)
+{
+	CHECK(index == VL53L1_SYSTEM__INTERMEASUREMENT_PERIOD, "write to %04x", index);
+	writes++;
+	return VL53L1_ERROR_NONE;
+}
+
+static uint32_t jitter(void)
+{
+	static uint32_t seed = 12345;
+
+	seed = seed * 1103515245 + 12345;
+	return (seed >> 16) % (MODEL_JITTER_US + 1);
+}
+
+static uint64_t periodNs(const model_sensor *pModel)
+{
+	return (uint64_t)pModel->reg * (1000000 + pModel->oscPpm) / 1000;
+}
+
+int main(void)
+{
+	static const int32_t oscPpm[MODEL_SENSORS] = {50000, -50000, 20000};
+	static const uint32_t startUs[MODEL_SENSORS] = {13000, 31000, 7000};
+	sync_state sync;
+	uint32_t minFrames = 0;
+	int32_t worst = 0;
+	uint8_t k;
+
+	VL53SyncInit(&sync, MODEL_PERIOD_MS, MODEL_SLOT_US, MODEL_LOCK_US);
+	for (k = 0; k < MODEL_SENSORS; k++)
+	{
+		CHECK(VL53SyncAdd(&sync, &dev[k]) == k, "sensor %u not added", k);
+		//SetInterMeasurementPeriodMilliSeconds() with one count per us
+		dev[k].Data.LLData.tim_cfg.system__intermeasurement_period = MODEL_PERIOD_MS * 1000;
+		model[k].oscPpm = oscPpm[k];
+		model[k].reg = MODEL_PERIOD_MS * 1000;
+		model[k].nextNs = (uint64_t)startUs[k] * 1000;
+		model[k].stream = 0xF0;	//wraps to 128 early on
+	}
+
+	while (minFrames < MODEL_FRAMES)
+	{
+		model_sensor *pModel;
+		uint32_t readyUs;
+		uint8_t next = 0;
+
+		for (k = 1; k < MODEL_SENSORS; k++)
+			if (model[k].nextNs < model[next].nextNs)
+				next = k;
+		pModel = &model[next];
+		nowNs = pModel->nextNs;
+		readyUs = Timebase_Us() + jitter();
+
+		//the next period is running already, a write applies to the one after it
+		pModel->nextNs += periodNs(pModel);
+		CHECK(VL53SyncFrame(&sync, next, readyUs, pModel->stream) == VL53L1_ERROR_NONE, "frame rejected");
+		pModel->reg = dev[next].Data.LLData.tim_cfg.system__intermeasurement_period;
+		pModel->stream = pModel->stream == 255 ? 128 : pModel->stream + 1;
+		pModel->frames++;
+
+		if (pModel->frames > MODEL_SETTLE)
+		{
+			int32_t phase = sync.sensor[next].phaseUs;
+
+			if (phase > worst || -phase > worst)
+				worst = phase < 0 ? -phase : phase;
+			CHECK(phase <= MODEL_LOCK_US && phase >= -MODEL_LOCK_US, "sensor %u frame %lu at %lu: phase %ld",
+					next, (unsigned long)pModel->frames, (unsigned long)readyUs, (long)phase);
+		}
+		minFrames = model[0].frames;
+		for (k = 1; k < MODEL_SENSORS; k++)
+			if (model[k].frames < minFrames)
+				minFrames = model[k].frames;
+	}
+
+	CHECK(Timebase_Us() < MODEL_T0_US, "the run did not cross the us wrap");
+	CHECK(VL53SyncLocked(&sync), "not locked at the end");
+	for (k = 0; k < MODEL_SENSORS; k++)
+		CHECK(sync.sensor[k].missed == 0, "sensor %u: %lu frames missed", k, (unsigned long)sync.sensor[k].missed);
+	printf("test_sync: worst phase after %u frames %ldus, %lu register writes\n", MODEL_SETTLE,
+			(long)worst, (unsigned long)writes);
+	return CHECK_RESULT("test_sync");
+}
@@ -0,0 +1,324 @@
+/*
+ * tunegen.c
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: dkupe
+ */
+
+#include "vl53l1x_tuning.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+//host side of the tuning profiles: turns a text file into the binary layout of
+//vl53l1x_tuning.h with the same VL53TuneBuild() the firmware uses, and dumps a binary
+//profile back to text.
+//
+//  tunegen [-c name] profile.txt out      out is the binary, or a C array with -c
+//  tunegen -d profile.bin                 prints the profile as text
+//
+//text format, one item per line, '#' starts a comment:
+//  keytable <n>      VL53L1_TUNINGPARM_KEY_TABLE_VERSION of the driver, required
+//  version <n>       profile version, default 0
+//  <key> <value>     key is the name without VL53L1_TUNINGPARM_ or a number,
+//                    values are decimal or 0x hex
+
+#define TUNEGEN_MAX_ENTRIES 256
+
+#define KEY(name) { #name, VL53L1_TUNINGPARM_##name }
+
+typedef struct
+{
+	const char *name;
+	uint16_t id;
+}key_name;
+
+static const key_name keyNames[] =
+{
+	KEY(VERSION),
+	KEY(KEY_TABLE_VERSION),
+	KEY(LLD_VERSION),
+	KEY(CONSISTENCY_LITE_PHASE_TOLERANCE),
+	KEY(PHASECAL_TARGET),
+	KEY(LITE_CAL_REPEAT_RATE),
+	KEY(LITE_RANGING_GAIN_FACTOR),
+	KEY(LITE_MIN_CLIP_MM),
+	KEY(LITE_LONG_SIGMA_THRESH_MM),
+	KEY(LITE_MED_SIGMA_THRESH_MM),
+	KEY(LITE_SHORT_SIGMA_THRESH_MM),
+	KEY(LITE_LONG_MIN_COUNT_RATE_RTN_MCPS),
+	KEY(LITE_MED_MIN_COUNT_RATE_RTN_MCPS),
+	KEY(LITE_SHORT_MIN_COUNT_RATE_RTN_MCPS),
+	KEY(LITE_SIGMA_EST_PULSE_WIDTH),
+	KEY(LITE_SIGMA_EST_AMB_WIDTH_NS),
+	KEY(LITE_SIGMA_REF_MM),
+	KEY(LITE_RIT_MULT),
+	KEY(LITE_SEED_CONFIG),
+	KEY(LITE_QUANTIFIER),
+	KEY(LITE_FIRST_ORDER_SELECT),
+	KEY(LITE_XTALK_MARGIN_KCPS),
+	KEY(INITIAL_PHASE_RTN_LITE_LONG_RANGE),
+	KEY(INITIAL_PHASE_RTN_LITE_MED_RANGE),
+	KEY(INITIAL_PHASE_RTN_LITE_SHORT_RANGE),
+	KEY(INITIAL_PHASE_REF_LITE_LONG_RANGE),
+	KEY(INITIAL_PHASE_REF_LITE_MED_RANGE),
+	KEY(INITIAL_PHASE_REF_LITE_SHORT_RANGE),
+	KEY(TIMED_SEED_CONFIG),
+	KEY(VHV_LOOPBOUND),
+	KEY(REFSPADCHAR_DEVICE_TEST_MODE),
+	KEY(REFSPADCHAR_VCSEL_PERIOD),
+	KEY(REFSPADCHAR_PHASECAL_TIMEOUT_US),
+	KEY(REFSPADCHAR_TARGET_COUNT_RATE_MCPS),
+	KEY(REFSPADCHAR_MIN_COUNTRATE_LIMIT_MCPS),
+	KEY(REFSPADCHAR_MAX_COUNTRATE_LIMIT_MCPS),
+	KEY(OFFSET_CAL_DSS_RATE_MCPS),
+	KEY(OFFSET_CAL_PHASECAL_TIMEOUT_US),
+	KEY(OFFSET_CAL_MM_TIMEOUT_US),
+	KEY(OFFSET_CAL_RANGE_TIMEOUT_US),
+	KEY(OFFSET_CAL_PRE_SAMPLES),
+	KEY(OFFSET_CAL_MM1_SAMPLES),
+	KEY(OFFSET_CAL_MM2_SAMPLES),
+	KEY(SPADMAP_VCSEL_PERIOD),
+	KEY(SPADMAP_VCSEL_START),
+	KEY(SPADMAP_RATE_LIMIT_MCPS),
+	KEY(LITE_DSS_CONFIG_TARGET_TOTAL_RATE_MCPS),
+	KEY(TIMED_DSS_CONFIG_TARGET_TOTAL_RATE_MCPS),
+	KEY(LITE_PHASECAL_CONFIG_TIMEOUT_US),
+	KEY(TIMED_PHASECAL_CONFIG_TIMEOUT_US),
+	KEY(LITE_MM_CONFIG_TIMEOUT_US),
+	KEY(TIMED_MM_CONFIG_TIMEOUT_US),
+	KEY(LITE_RANGE_CONFIG_TIMEOUT_US),
+	KEY(TIMED_RANGE_CONFIG_TIMEOUT_US),
+	KEY(LOWPOWERAUTO_VHV_LOOP_BOUND),
+	KEY(LOWPOWERAUTO_MM_CONFIG_TIMEOUT_US),
+	KEY(LOWPOWERAUTO_RANGE_CONFIG_TIMEOUT_US),
+};
+
+#define KEY_COUNT (sizeof(keyNames) / sizeof(keyNames[0]))
+
+//VL53TuneApply/Capture reference the driver, the tool never calls them
+VL53L1_Error VL53L1_get_tuning_parm(VL53L1_DEV Dev, VL53L1_TuningParms tuning_parm_key, int32_t *ptuning_parm_value)
+{
+	return VL53L1_ERROR_NOT_SUPPORTED;
+}
+
+VL53L1_Error VL53L1_set_tuning_parm(VL53L1_DEV Dev, VL53L1_TuningParms tuning_parm_key, int32_t tuning_parm_value)
+{
+	return VL53L1_ERROR_NOT_SUPPORTED;
+}
+
+static const char *keyName(uint16_t id)
+{
+	size_t i;
+
+	for (i = 0; i < KEY_COUNT; i++)
+		if (keyNames[i].id == id)
+			return keyNames[i].name;
+	return NULL;
+}
+
+static int keyId(const char *text, uint16_t *pId)
+{
+	char *end;
+	unsigned long value;
+	size_t i;
+
+	if (strncmp(text, "VL53L1_TUNINGPARM_", 18) == 0)
+		text += 18;
+	for (i = 0; i < KEY_COUNT; i++)
+		if (strcmp(keyNames[i].name, text) == 0)
+		{
+			*pId = keyNames[i].id;
+			return 1;
+		}
+	value = strtoul(text, &end, 0);
+	if (!isdigit((unsigned char)text[0]) || *end != '\0' || value > 0xFFFF)
+		return 0;
+	*pId = (uint16_t)value;
+	return 1;
+}
+
+static int number(const char *text, long long min, long long max, long long *pValue)
+{
+	char *end;
+	long long value = strtoll(text, &end, 0);
+
+	if (end == text || *end != '\0' || value < min || value > max)
+		return 0;
+	*pValue = value;
+	return 1;
+}
+
+//returns 0 after printing the first error
+static int readText(const char *path, uint16_t *pKeyTable, uint16_t *pVersion, tune_entry *pEntries, uint16_t *pCount)
+{
+	FILE *f = fopen(path, "r");
+	char line[256];
+	int lineNo = 0, haveKeyTable = 0, ok = 1;
+
+	if (f == NULL)
+	{
+		perror(path);
+		return 0;
+	}
+	*pVersion = 0;
+	*pCount = 0;
+	while (ok && fgets(line, sizeof(line), f))
+	{
+		char key[128], value[64], extra[2];
+		char *comment = strchr(line, '#');
+		tune_entry *pEntry = &pEntries[*pCount];
+		long long v;
+		int n;
+
+		lineNo++;
+		if (comment != NULL)
+			*comment = '\0';
+		n = sscanf(line, "%127s %63s %1s", key, value, extra);
+		if (n <= 0)
+			continue;
+		ok = 0;
+		if (n != 2)
+			fprintf(stderr, "%s:%d: expected <key> <value>\n", path, lineNo);
+		else if (strcmp(key, "keytable") == 0 || strcmp(key, "version") == 0)
+		{
+			if (!number(value, 0, 0xFFFF, &v))
+				fprintf(stderr, "%s:%d: bad %s %s\n", path, lineNo, key, value);
+			else if (key[0] == 'k')
+			{
+				*pKeyTable = (uint16_t)v;
+				haveKeyTable = ok = 1;
+			}
+			else
+			{
+				*pVersion = (uint16_t)v;
+				ok = 1;
+			}
+		}
+		else if (*pCount == TUNEGEN_MAX_ENTRIES)
+			fprintf(stderr, "%s:%d: more than %d entries\n", path, lineNo, TUNEGEN_MAX_ENTRIES);
+		else if (!keyId(key, &pEntry->id))
+			fprintf(stderr, "%s:%d: unknown key %s\n", path, lineNo, key);
+		else if (pEntry->id == VL53L1_TUNINGPARM_VERSION || pEntry->id == VL53L1_TUNINGPARM_KEY_TABLE_VERSION ||
+				pEntry->id == VL53L1_TUNINGPARM_LLD_VERSION)
+			//VL53TuneApply() rejects a profile with these
+			fprintf(stderr, "%s:%d: %s is not tunable\n", path, lineNo, key);
+		else if (!number(value, INT32_MIN, UINT32_MAX, &v))
+			fprintf(stderr, "%s:%d: bad value %s\n", path, lineNo, value);
+		else
+		{
+			pEntry->value = (int32_t)(uint32_t)v;
+			(*pCount)++;
+			ok = 1;
+		}
+	}
+	fclose(f);
+	if (ok && !haveKeyTable)
+	{
+		fprintf(stderr, "%s: no keytable line\n", path);
+		ok = 0;
+	}
+	return ok;
+}
+
+static int writeOutput(const char *path, const char *arrayName, const uint8_t *buf, uint32_t size)
+{
+	FILE *f = fopen(path, arrayName ? "w" : "wb");
+	uint32_t i;
+	int ok;
+
+	if (f == NULL)
+	{
+		perror(path);
+		return 0;
+	}
+	if (arrayName == NULL)
+		fwrite(buf, 1, size, f);
+	else
+	{
+		fprintf(f, "//generated by tunegen, %lu bytes\n", (unsigned long)size);
+		fprintf(f, "const uint8_t %s[%lu] =\n{", arrayName, (unsigned long)size);
+		for (i = 0; i < size; i++)
+			fprintf(f, "%s0x%02X,", (i % 12) ? " " : "\n\t", buf[i]);
+		fprintf(f, "\n};\n");
+	}
+	ok = !ferror(f);
+	if (fclose(f) != 0 || !ok)
+	{
+		perror(path);
+		return 0;
+	}
+	return 1;
+}
+
+static int dump(const char *path)
+{
+	static uint8_t buf[TUNE_SIZE(TUNEGEN_MAX_ENTRIES)];
+	FILE *f = fopen(path, "rb");
+	tune_profile profile;
+	tune_entry entry;
+	uint32_t len;
+	uint16_t i;
+
+	if (f == NULL)
+	{
+		perror(path);
+		return 0;
+	}
+	len = (uint32_t)fread(buf, 1, sizeof(buf), f);
+	fclose(f);
+	if (VL53TuneParse(buf, len, &profile) != VL53L1_ERROR_NONE)
+	{
+		fprintf(stderr, "%s: not a tuning profile or bad CRC\n", path);
+		return 0;
+	}
+	printf("keytable %u\nversion %u\n", profile.keyTable, profile.version);
+	for (i = 0; i < profile.count; i++)
+	{
+		const char *name;
+
+		VL53TuneEntry(&profile, i, &entry);
+		name = keyName(entry.id);
+		if (name != NULL)
+			printf("%s %ld\n", name, (long)entry.value);
+		else
+			printf("%u %ld\n", entry.id, (long)entry.value);
+	}
+	return 1;
+}
+
+static int usage(void)
+{
+	fprintf(stderr, "usage: tunegen [-c name] profile.txt out\n"
+			"       tunegen -d profile.bin\n");
+	return 2;
+}
+
+int main(int argc, char **argv)
+{
+	static tune_entry entries[TUNEGEN_MAX_ENTRIES];
+	static uint8_t buf[TUNE_SIZE(TUNEGEN_MAX_ENTRIES)];
+	const char *arrayName = NULL;
+	uint16_t keyTable = 0, version, count;
+	uint32_t size;
+
+	if (argc == 3 && strcmp(argv[1], "-d") == 0)
+		return dump(argv[2]) ? 0 : 1;
+	if (argc == 5 && strcmp(argv[1], "-c") == 0)
+	{
+		arrayName = argv[2];
+		argv += 2;
+		argc -= 2;
+	}
+	if (argc != 3)
+		return usage();
+	if (!readText(argv[1], &keyTable, &version, entries, &count))
+		return 1;
+	size = VL53TuneBuild(buf, sizeof(buf), keyTable, version, entries, count);
+	if (size == 0 || !writeOutput(argv[2], arrayName, buf, size))
+		return 1;
+	printf("%s: %u entries, %lu bytes, crc %08lX\n", argv[2], count, (unsigned long)size,
+			(unsigned long)VL53TuneCrc(buf, size - TUNE_CRC_SIZE));
+	return 0;
+}